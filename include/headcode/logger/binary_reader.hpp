@@ -0,0 +1,149 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_BINARY_READER_HPP
+#define HEADCODE_SPACE_LOGGER_BINARY_READER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A single event read from a binary log.
+ */
+struct BinaryRecord {
+    std::chrono::system_clock::time_point time_point;        //!< @brief When the event happened.
+    int level{0};                                            //!< @brief Log level value (see level.hpp).
+    std::uint64_t thread_id{0};                              //!< @brief The id of the thread of the event.
+    std::string logger;                                      //!< @brief Logger name (empty for the root logger).
+    std::string message;                                     //!< @brief The message of the event.
+};
+
+
+/**
+ * @brief   A block of a binary log (see BinaryReader::LoadIndex()).
+ *
+ * Indexed blocks have been summarized by the BinaryFormatter with an index record.
+ * Blocks without an index (e.g. the very last events of a file) are still listed, yet
+ * only their position is known.
+ */
+struct BinaryBlock {
+    std::uint64_t offset{0};                                 //!< @brief Position of the first byte of the block.
+    std::uint64_t size{0};                                   //!< @brief Size of the block in bytes (incl. index).
+    bool indexed{false};                                     //!< @brief The summary fields below are valid.
+    bool session{false};                                     //!< @brief Block continues a session (base is valid).
+    std::chrono::system_clock::time_point base;              //!< @brief Time before the first event.
+    std::chrono::system_clock::time_point first;             //!< @brief Time of the earliest event.
+    std::chrono::system_clock::time_point last;              //!< @brief Time of the latest event.
+    std::chrono::system_clock::time_point end;               //!< @brief Time of the event written last.
+    int min_level{0};                                        //!< @brief Lowest level value in this block.
+    int max_level{0};                                        //!< @brief Highest level value in this block.
+    std::uint64_t events{0};                                 //!< @brief Number of events in this block.
+    std::vector<std::string> loggers;                        //!< @brief Logger names used in this block.
+};
+
+
+/**
+ * @brief   Reads the events of a binary log as written by the BinaryFormatter.
+ *
+ * Example:
+ * @code
+ *      std::ifstream in{"app.hlog", std::ios::binary};
+ *      headcode::logger::BinaryReader reader{in};
+ *      headcode::logger::BinaryRecord record;
+ *      while (reader.Next(record)) {
+ *          std::cout << headcode::logger::StandardFormatter::Render(record.time_point,
+ *                                                                   record.level,
+ *                                                                   record.logger,
+ *                                                                   record.message);
+ *      }
+ * @endcode
+ *
+ * To look only at some events of a big file, load the index first and seek to the blocks
+ * of interest:
+ * @code
+ *      for (auto const & block : headcode::logger::BinaryReader::LoadIndex(in)) {
+ *          if (block.indexed && (block.last < from)) {
+ *              continue;
+ *          }
+ *          reader.Seek(block);
+ *          while (reader.Next(record)) {
+ *              ...
+ *          }
+ *      }
+ * @endcode
+ */
+class BinaryReader {
+
+    std::istream & in_;                                    //!< @brief The stream to read from.
+    bool error_{false};                                    //!< @brief Malformed data has been encountered.
+    bool header_read_{false};                              //!< @brief We are within a session.
+    std::int64_t last_time_{0};                            //!< @brief Microseconds since epoch of the last record.
+    std::map<std::uint64_t, std::string> loggers_;         //!< @brief Logger names of the session by id.
+    std::map<std::uint64_t, std::string> templates_;       //!< @brief Message templates of the block by id.
+    std::uint64_t limit_{std::numeric_limits<std::uint64_t>::max()};        //!< @brief Stop reading here.
+
+public:
+    /**
+     * @brief   Constructor.
+     * @param   in          the stream holding the binary log.
+     */
+    explicit BinaryReader(std::istream & in) : in_{in} {
+    }
+
+    /**
+     * @brief   Checks if malformed data has been read.
+     * @return  true, if reading stopped due to malformed data.
+     */
+    [[nodiscard]] bool HasError() const {
+        return error_;
+    }
+
+    /**
+     * @brief   Collects the blocks of a binary log.
+     *
+     * This hops backwards from index record to index record, reading only these. Parts of
+     * the file which are not covered by an index (e.g. the last events or a session which
+     * stopped in the middle of a block) are searched through for earlier index records.
+     *
+     * @param   in          a seekable stream holding the binary log.
+     * @return  All blocks of the binary log, ordered by position.
+     */
+    static std::vector<BinaryBlock> LoadIndex(std::istream & in);
+
+    /**
+     * @brief   Reads the next event.
+     * @param   record      receives the next event.
+     * @return  true, if an event has been read; false at the end of data or on error (see HasError()).
+     */
+    bool Next(BinaryRecord & record);
+
+    /**
+     * @brief   Restricts reading to a single block.
+     * Subsequent calls to Next() return the events of this block only.
+     * @param   block       a block as found by LoadIndex() on the very same stream.
+     */
+    void Seek(BinaryBlock const & block);
+};
+
+
+}
+
+
+#endif
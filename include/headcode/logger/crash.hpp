@@ -0,0 +1,54 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_CRASH_HPP
+#define HEADCODE_SPACE_LOGGER_CRASH_HPP
+
+#include <chrono>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Installs handlers for fatal signals (SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT).
+ *
+ * When the process crashes, sinks holding events in memory write these out with
+ * async-signal-safe code: "ring:" sinks, buffered file sinks ("file:...?buffer=") and the
+ * queues of network sinks. Then the signal is raised again with its default action, so
+ * core dumps and exit codes stay the same.
+ *
+ * Writing out is limited by a time budget: sinks stop waiting for slow peers when it is
+ * used up, and an alarm ends the process should a write hang nevertheless.
+ *
+ * The handler runs on an alternate signal stack, so a stack overflow is caught as well.
+ * The calling thread gets one right away, any other thread with its first log event after
+ * this call. Threads which logged before are not covered: call this early in main().
+ *
+ * Example:
+ * @code
+ *      int main(int argc, char ** argv) {
+ *          headcode::logger::InstallCrashHandler();
+ *          auto sink = headcode::logger::SinkFactory::Create("ring:?events=1000&target=stderr:");
+ *          headcode::logger::Logger::GetLogger()->SetSink(sink);
+ *          ...
+ *      }
+ * @endcode
+ *
+ * @param   budget      time to write out events on a crash.
+ */
+void InstallCrashHandler(std::chrono::milliseconds budget = std::chrono::milliseconds{1000});
+
+
+}
+
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_EMERGENCY_HPP
+#define HEADCODE_SPACE_LOGGER_EMERGENCY_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A Critical message written straight to file descriptors, usable where events are not.
+ *
+ * An Emergency is assembled on the stack and written with write(2) when it goes out of
+ * scope: to stderr and any descriptor added with AddEmergencyDescriptor(). It never
+ * allocates memory, takes no locks and bypasses loggers, barriers and sinks, so it may be
+ * used in signal handlers, after memory ran out or while a sink's mutex is held.
+ *
+ * The lines look like the ones of the StandardFormatter (with the time in UTC). Messages
+ * longer than kCapacity bytes are cut off.
+ *
+ * Example:
+ * @code
+ *      void OnSignal(int signal_number) {
+ *          headcode::logger::Emergency{"app"} << "caught signal " << signal_number;
+ *      }
+ * @endcode
+ */
+class Emergency {
+
+public:
+    static constexpr std::size_t kCapacity = 896;       //!< @brief Maximum size of the message.
+
+private:
+    char const * logger_name_;          //!< @brief The logger name (not copied); may be nullptr.
+    char message_[kCapacity];           //!< @brief The message.
+    std::size_t size_{0};               //!< @brief The number of bytes of the message.
+
+public:
+    /**
+     * @brief   Constructor.
+     * @param   logger_name     the logger name shown; the string has to outlive the object.
+     */
+    explicit Emergency(char const * logger_name = nullptr) noexcept : logger_name_{logger_name} {
+    }
+
+    /**
+     * @brief   Copy constructor.
+     */
+    Emergency(Emergency const &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    Emergency(Emergency &&) = delete;
+
+    /**
+     * @brief   Destructor: writes the message.
+     */
+    ~Emergency() noexcept;
+
+    /**
+     * @brief   Assignment operator.
+     */
+    Emergency & operator=(Emergency const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    Emergency & operator=(Emergency &&) = delete;
+
+    /**
+     * @brief   Appends text.
+     * @param   text        the text.
+     * @return  This object.
+     */
+    Emergency & operator<<(std::string_view text) noexcept;
+
+    /**
+     * @brief   Appends a zero terminated string.
+     * @param   text        the string; nullptr is shown as "(null)".
+     * @return  This object.
+     */
+    Emergency & operator<<(char const * text) noexcept {
+        return *this << std::string_view{(text != nullptr) ? text : "(null)"};
+    }
+
+    /**
+     * @brief   Appends a single character.
+     * @param   c           the character.
+     * @return  This object.
+     */
+    Emergency & operator<<(char c) noexcept {
+        return *this << std::string_view{&c, 1};
+    }
+
+    /**
+     * @brief   Appends an integer in decimal.
+     * @param   value       the integer.
+     * @return  This object.
+     */
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    Emergency & operator<<(T value) noexcept {
+        if constexpr (std::is_same_v<T, bool>) {
+            return *this << std::string_view{value ? "true" : "false"};
+        } else if constexpr (std::is_signed_v<T>) {
+            return AppendNumber(static_cast<unsigned long long>(value < 0 ? -(value + 1) : value) + (value < 0 ? 1 : 0),
+                                value < 0);
+        } else {
+            return AppendNumber(value, false);
+        }
+    }
+
+    /**
+     * @brief   Appends a pointer in hexadecimal.
+     * @param   pointer     the pointer.
+     * @return  This object.
+     */
+    Emergency & operator<<(void const * pointer) noexcept;
+
+    /**
+     * @brief   Gets the message assembled so far.
+     * @return  The message.
+     */
+    [[nodiscard]] std::string_view GetMessage() const noexcept {
+        return std::string_view{message_, size_};
+    }
+
+private:
+    /**
+     * @brief   Appends a number in decimal.
+     * @param   value       the absolute value of the number.
+     * @param   negative    the number is negative.
+     * @return  This object.
+     */
+    Emergency & AppendNumber(unsigned long long value, bool negative) noexcept;
+};
+
+
+/**
+ * @brief   Adds a file descriptor Emergency messages are written to (stderr is there from the start).
+ * This is lock-free and async-signal-safe. There is room for 8 descriptors.
+ * @param   fd          the file descriptor; it has to stay open while added.
+ * @return  true, if the descriptor has been added (or was there already).
+ */
+bool AddEmergencyDescriptor(int fd) noexcept;
+
+
+/**
+ * @brief   Removes a file descriptor Emergency messages are written to.
+ * This is lock-free and async-signal-safe.
+ * @param   fd          the file descriptor (e.g. 2 to keep Emergency messages off stderr).
+ */
+void RemoveEmergencyDescriptor(int fd) noexcept;
+
+
+}
+
+
+#endif
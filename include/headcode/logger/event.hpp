@@ -11,8 +11,12 @@
 
 #include "level.hpp"
 
+#include <array>
 #include <chrono>
+#include <cstdint>
+#include <list>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <utility>
 
@@ -23,7 +27,19 @@
 namespace headcode::logger {
 
 
-class Logger;        //!< @brief Forward declaration of an event.
+class Formatter;        //!< @brief Forward declaration of a formatter.
+class Logger;           //!< @brief Forward declaration of a logger.
+
+
+/**
+ * @brief   The phase of a trace event (as in the Chrome trace event format).
+ */
+enum class TracePhase : char {
+    kNone = 0,              //!< @brief A regular event, not a trace event.
+    kBegin = 'B',           //!< @brief Begin of a duration.
+    kEnd = 'E',             //!< @brief End of a duration.
+    kComplete = 'X'         //!< @brief A whole duration: the event's time point is the begin.
+};
 
 
 /**
@@ -50,6 +66,14 @@ class Logger;        //!< @brief Forward declaration of an event.
  * Events are derived from std::stringstream and therefore anything
  * you can do to a std::stringstream, you can do to events too.
  *
+ * An event remembers how it has been rendered by formatters. If the very same
+ * event is pushed to several sinks using the same kind of formatter (see
+ * Formatter::GetRenderKey()), the final text is created only once and shared
+ * among these sinks. The renderings are tied to the thread logging the event.
+ *
+ * Events may also mark the begin, end or whole of a duration (see TraceEvent and
+ * ScopedTimer) to be shown on a timeline (see ChromeFormatter).
+ *
  * Example:
  * @code
  *      Event{kInfo, "app.database"} << "Created a new entry. "
@@ -59,10 +83,34 @@ class Logger;        //!< @brief Forward declaration of an event.
  */
 class Event : public std::stringstream {
 
+    /**
+     * @brief   A text created by a formatter for this event.
+     */
+    struct Rendering {
+        std::uint64_t generation_{0};                  //!< @brief Generation of the formatter which rendered it.
+        std::string key_;                              //!< @brief The render key of the formatter.
+        std::streamoff message_size_{0};               //!< @brief The size of the message when rendered.
+        std::string text_;                             //!< @brief The rendered text.
+    };
+
+    /**
+     * @brief   Number of renderings kept within the event; more are kept in a list.
+     */
+    static constexpr std::size_t kInlineRenderings = 3;
+
     std::chrono::system_clock::time_point time_point_;        //!< @brief When the event happened.
     Logger * logger_;                                         //!< @brief The logger the event is assigned.
     int level_;                                               //!< @brief Log level value (see level.hpp)
     std::chrono::microseconds since_start_;                   //!< @brief Microseconds since start of logger subsystem
+    std::uint64_t thread_id_;                                 //!< @brief The id of the thread creating the event.
+    mutable std::uint64_t sequence_{0};                       //!< @brief Number of the event; 0 until asked for.
+    bool log_on_destruction_{true};                           //!< @brief Hand the event to the logger when done.
+    bool backtrace_{false};                                   //!< @brief Replayed from a backtrace buffer.
+    TracePhase trace_phase_{TracePhase::kNone};               //!< @brief Phase of a trace event.
+    std::chrono::microseconds trace_duration_{0};            //!< @brief Duration of a complete trace event.
+    mutable std::array<Rendering, kInlineRenderings> renderings_;        //!< @brief First texts rendered.
+    mutable std::size_t renderings_used_{0};                               //!< @brief Renderings in renderings_.
+    mutable std::list<Rendering> more_renderings_;                         //!< @brief Texts rendered beyond these.
 
 public:
     /**
@@ -93,6 +141,22 @@ public:
      */
     Event(int level, Logger * logger);
 
+    /**
+     * @brief   Constructor for replaying a recorded event.
+     * The event carries the given values instead of the current ones and is *not* handed to
+     * the logger when destroyed: push it to sinks directly (Sink::Log()).
+     * @param   time_point          When the event happened.
+     * @param   level               The log level (see level.hpp)
+     * @param   logger              The logger this event is addressed to.
+     * @param   thread_id           The id of the thread which created the event.
+     * @param   message             The message.
+     */
+    Event(std::chrono::system_clock::time_point time_point,
+          int level,
+          Logger * logger,
+          std::uint64_t thread_id,
+          std::string const & message);
+
     /**
      * @brief   Copy constructor.
      */
@@ -118,6 +182,26 @@ public:
      */
     Event & operator=(Event &&) = delete;
 
+    /**
+     * @brief   Remembers a rendering of this event.
+     * @param   formatter       the formatter which rendered the text.
+     * @param   key             the render key of the formatter.
+     * @param   text            the rendered text.
+     * @return  The rendering stored within this event.
+     */
+    std::string const & AddRendering(Formatter const & formatter, std::string const & key, std::string text) const;
+
+    /**
+     * @brief   Finds a previous rendering of this event.
+     * A rendering matches if it has been created by the very same formatter (see
+     * Formatter::GetGeneration()) or by a formatter with
+     * the same non-empty render key. Renderings of a message which has been changed since are ignored.
+     * @param   formatter       the formatter about to render this event.
+     * @param   key             the render key of the formatter.
+     * @return  The previously rendered text or nullptr if there is none.
+     */
+    [[nodiscard]] std::string const * FindRendering(Formatter const & formatter, std::string const & key) const;
+
     /**
      * @brief   Gets the "age" of the event compared to the start of the log subsystem.
      * The start of the log subsystem is the very first access to any of
@@ -160,6 +244,49 @@ public:
         return str();
     }
 
+    /**
+     * @brief   Returns the created message (so far) without copying it.
+     * The view is valid until more is written to the event.
+     * @return  The message.
+     */
+    std::string_view GetMessageView() const;
+
+    /**
+     * @brief   Gets the id of the thread which created this event.
+     * This is the operating system's thread id (as shown by `top -H` or `ps -L`).
+     * @return  The id of the thread of this event.
+     */
+    std::uint64_t GetThreadId() const {
+        return thread_id_;
+    }
+
+    /**
+     * @brief   Gets the sequence number of this event.
+     * Events are numbered within the process, starting with 1, when first asked for their
+     * number: as formatters writing it (GELFFormatter, OTLPFormatter) format the event.
+     * Other events never touch the shared counter. Sinks may send urgent events ahead of
+     * others (see QueueSink): the sequence numbers restore the original order.
+     * @return  The sequence number of this event.
+     */
+    std::uint64_t GetSequence() const;
+
+    /**
+     * @brief   Checks if this event has been held back and is replayed from a backtrace buffer.
+     * See Logger::SetBacktraceDepth().
+     * @return  true, if this is a backtrace event.
+     */
+    bool IsBacktrace() const {
+        return backtrace_;
+    }
+
+    /**
+     * @brief   Marks this event as replayed from a backtrace buffer.
+     * @param   backtrace       the new backtrace flag.
+     */
+    void SetBacktrace(bool backtrace) {
+        backtrace_ = backtrace;
+    }
+
     /**
      * @brief   Gets the time point when this event has been recorded.
      * @return  The time point of this event.
@@ -167,6 +294,33 @@ public:
     std::chrono::system_clock::time_point GetTimePoint() const {
         return time_point_;
     }
+
+    /**
+     * @brief   Gets the duration of a complete trace event.
+     * @return  The duration (0 for all other events).
+     */
+    std::chrono::microseconds GetTraceDuration() const {
+        return trace_duration_;
+    }
+
+    /**
+     * @brief   Gets the trace phase of this event.
+     * @return  The trace phase; TracePhase::kNone for regular events.
+     */
+    TracePhase GetTracePhase() const {
+        return trace_phase_;
+    }
+
+protected:
+    /**
+     * @brief   Turns this event into a trace event.
+     * @param   phase           the trace phase.
+     * @param   time_point      when the traced phase started.
+     * @param   duration        the duration of a complete trace event.
+     */
+    void SetTrace(TracePhase phase,
+                  std::chrono::system_clock::time_point time_point,
+                  std::chrono::microseconds duration);
 };
 
 
@@ -258,6 +412,40 @@ public:
 };
 
 
+/**
+ * @brief   A trace event: the begin, end or whole of a named duration.
+ * The message of the event is the name of the duration. Mostly created by a ScopedTimer.
+ *
+ * Example:
+ * @code
+ *      TraceEvent{"app.db", "query", TracePhase::kComplete, start, std::chrono::microseconds{1200}};
+ * @endcode
+ */
+class TraceEvent : public Event {
+
+public:
+    /**
+     * @brief   Constructor.
+     * @param   logger_name         The name of the logger this event is addressed to.
+     * @param   name                The name of the duration.
+     * @param   phase               The trace phase.
+     * @param   time_point          When the traced phase started.
+     * @param   duration            The duration of a complete trace event.
+     * @param   level               The log level (see level.hpp)
+     */
+    TraceEvent(std::string logger_name,
+               std::string const & name,
+               TracePhase phase,
+               std::chrono::system_clock::time_point time_point = std::chrono::system_clock::now(),
+               std::chrono::microseconds duration = std::chrono::microseconds{0},
+               Level level = Level::kDebug)
+            : Event(level, std::move(logger_name)) {
+        SetTrace(phase, time_point, duration);
+        write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+};
+
+
 }
 
 
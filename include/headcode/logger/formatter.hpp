@@ -9,8 +9,14 @@
 #ifndef HEADCODE_SPACE_LOGGER_FORMATTER_HPP
 #define HEADCODE_SPACE_LOGGER_FORMATTER_HPP
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 
 /**
@@ -19,30 +25,37 @@
 namespace headcode::logger {
 
 
-class Event;        //!< @brief Forward declaration of an event.
+class Event;         //!< @brief Forward declaration of an event.
+class Logger;        //!< @brief Forward declaration of a logger.
 
 
 /**
  * @brief   A formatter re-formats the message for the final log.
- * @tparam  T       the type of the log events to convert into plain log strings.
+ *
+ * The texts produced are stored within the event. Formatters returning the same
+ * non-empty render key (see GetRenderKey()) produce the very same text for any event.
+ * Hence, an event pushed to several sinks with formatters of the same key is
+ * formatted only once.
  */
 class Formatter {
 
+    std::uint64_t generation_;          //!< @brief Number of this formatter (see GetGeneration()).
+
 public:
     /**
      * @brief   Constructor
      */
-    Formatter() = default;
+    Formatter();
 
     /**
      * @brief   Copy constructor
      */
-    Formatter(Formatter const &) = default;
+    Formatter(Formatter const &);
 
     /**
      * @brief   Move constructor
      */
-    Formatter(Formatter &&) = default;
+    Formatter(Formatter &&) noexcept;
 
     /**
      * @brief   Destructor
@@ -52,12 +65,12 @@ public:
     /**
      * @brief   Assignment operator.
      */
-    Formatter & operator=(Formatter const &) = default;
+    Formatter & operator=(Formatter const &);
 
     /**
      * @brief   Move operator.
      */
-    Formatter & operator=(Formatter &&) = default;
+    Formatter & operator=(Formatter &&) noexcept;
 
     /**
      * @brief   Creates the level string from the given event.
@@ -66,6 +79,13 @@ public:
      */
     static std::string CreateLevelString(Event const & event);
 
+    /**
+     * @brief   Creates the level string from the given level value.
+     * @param   level       the log level value.
+     * @return  A string depicting the level.
+     */
+    static std::string CreateLevelString(int level);
+
     /**
      * @brief   Creates the logger string from the given event.
      * @param   event       the log event.
@@ -73,6 +93,13 @@ public:
      */
     static std::string CreateLoggerString(Event const & event);
 
+    /**
+     * @brief   Creates the logger string from the given logger name.
+     * @param   name        the name of the logger (empty or "<root>" for the root logger).
+     * @return  A string depicting the logger (the associated event source).
+     */
+    static std::string CreateLoggerString(std::string const & name);
+
     /**
      * @brief   Creates the time string from the given event.
      * @param   event       the log event.
@@ -81,14 +108,40 @@ public:
     static std::string CreateTimeString(Event const & event);
 
     /**
-     * @brief   Formats the log event of type T to produce the final log string.
+     * @brief   Creates the time string from the given time point.
+     * @param   time_point  the time point.
+     * @return  A string holding the time.
+     */
+    static std::string CreateTimeString(std::chrono::system_clock::time_point time_point);
+
+    /**
+     * @brief   Formats the log event to produce the final log string.
+     * If the event has already been formatted by this formatter or a formatter with the same
+     * render key, then this previous rendering is returned.
      * @param   event       the log event to format.
-     * @return  A string drawn from that log event.
+     * @return  A string drawn from that log event (valid as long as the event lives).
+     */
+    std::string const & Format(Event const & event);
+
+    /**
+     * @brief   Returns the generation of this formatter.
+     * Each formatter gets a number of its own when created or assigned to. Unlike the address of
+     * a formatter, it is never reused by another formatter later on.
+     * @return  The generation of this formatter.
      */
-    std::string Format(Event const & event) {
-        return Format_(event);
+    [[nodiscard]] std::uint64_t GetGeneration() const noexcept {
+        return generation_;
     }
 
+    /**
+     * @brief   Returns the render key of this formatter.
+     * Formatters with the same non-empty key must render any event into the very same text.
+     * Stateful formatters or formatters which depend on the sink must return an empty key,
+     * which is the default.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] virtual std::string const & GetRenderKey() const;
+
     /**
      * @brief   Split the message into lines.
      * @param   message     the message.
@@ -111,6 +164,13 @@ private:
  */
 class SimpleFormatter : public Formatter {
 
+public:
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
 private:
     /**
      * @brief   The detailed formatter function to reimplement in derived classes.
@@ -126,6 +186,27 @@ private:
  */
 class StandardFormatter : public Formatter {
 
+public:
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
+    /**
+     * @brief   Renders the values of an event in the standard layout.
+     * This is used to present events which have been recorded elsewhere (e.g. in binary logs).
+     * @param   time_point      the time point of the event.
+     * @param   level           the log level value of the event.
+     * @param   logger_name     the name of the logger of the event (empty for the root logger).
+     * @param   message         the message of the event.
+     * @return  The event in the standard layout.
+     */
+    static std::string Render(std::chrono::system_clock::time_point time_point,
+                              int level,
+                              std::string const & logger_name,
+                              std::string const & message);
+
 private:
     /**
      * @brief   The detailed formatter function to reimplement in derived classes.
@@ -136,12 +217,253 @@ private:
 };
 
 
+/**
+ * @brief   A formatter which produces compact binary records.
+ *
+ * Instead of text, the sink receives records made of variable length integers
+ * (level, logger id, thread id, microseconds passed since the previous record)
+ * followed by the message bytes. Logger names are written only once into the
+ * stream, when a logger shows up the first time. The very first output of a
+ * formatter starts with a header holding the absolute time, so appending to an
+ * existing file is fine.
+ *
+ * Hence the output depends on what this formatter has written before: only
+ * use it for a single sink writing into a file (e.g. "file:app.hlog") and read
+ * the result with the BinaryReader or the `hcs-logcat` tool.
+ *
+ * Every time about `index_block_size` bytes have been written, an index record
+ * closes the current block. It summarizes the block (time range, levels, loggers)
+ * and ends with a fixed size trailer. Starting at the end of a file readers hop
+ * from index record to index record (see BinaryReader::LoadIndex()) and only
+ * decode the blocks of interest.
+ *
+ * With templates turned on, the numbers of a message are cut out and the remaining
+ * text is written only once per block as a template. Repeated messages like
+ * "request done in 42 us" then cost a template id and the numbers only.
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("file:app.hlog");
+ *      sink->SetFormatter(std::make_unique<headcode::logger::BinaryFormatter>());
+ * @endcode
+ *
+ * The same, with templates, configured by URL only:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("file:app.hlog?format=binary&templates=true");
+ * @endcode
+ */
+class BinaryFormatter : public Formatter {
+
+    /**
+     * @brief   Summary of the current block.
+     */
+    struct Block {
+        std::uint64_t size_{0};                     //!< @brief Bytes written so far in this block.
+        std::uint64_t events_{0};                   //!< @brief Events written so far in this block.
+        std::int64_t base_{0};                      //!< @brief Microseconds since epoch before the first event.
+        std::int64_t first_{0};                     //!< @brief Microseconds since epoch of the earliest event.
+        std::int64_t last_{0};                      //!< @brief Microseconds since epoch of the latest event.
+        int min_level_{0};                          //!< @brief Lowest level value in this block.
+        int max_level_{0};                          //!< @brief Highest level value in this block.
+        std::vector<std::string> loggers_;          //!< @brief Names of the loggers in this block.
+    };
+
+    std::mutex mutex_;                                 //!< @brief Guards the state of the formatter.
+    std::size_t index_block_size_;                     //!< @brief Block size after which an index is written.
+    bool header_written_{false};                       //!< @brief The stream header has been written.
+    std::int64_t last_time_{0};                        //!< @brief Microseconds since epoch of the last record.
+    std::vector<Logger const *> known_loggers_;        //!< @brief Loggers already written, indexed by logger id.
+    Block block_;                                      //!< @brief The current block.
+    bool templates_;                                   //!< @brief Write messages as templates and parameters.
+    std::unordered_map<std::string, std::uint64_t> known_templates_;        //!< @brief Template ids of the block.
+
+public:
+    /**
+     * @brief   Default size of blocks covered by an index record.
+     */
+    static constexpr std::size_t kDefaultIndexBlockSize = 64 * 1024;
+
+    /**
+     * @brief   Maximum number of templates per block; further messages are written as they are.
+     */
+    static constexpr std::size_t kMaxTemplates = 4096;
+
+    /**
+     * @brief   Messages longer than this are not turned into templates.
+     */
+    static constexpr std::size_t kMaxTemplateSize = 1024;
+
+    /**
+     * @brief   Constructor
+     * @param   index_block_size    write an index record every this many bytes (0 turns off indexing).
+     * @param   templates           write messages as templates and parameters.
+     */
+    explicit BinaryFormatter(std::size_t index_block_size = kDefaultIndexBlockSize, bool templates = false)
+            : index_block_size_{index_block_size}, templates_{templates} {
+    }
+
+    /**
+     * @brief   Copy constructor
+     */
+    BinaryFormatter(BinaryFormatter const &) = delete;
+
+    /**
+     * @brief   Move constructor
+     */
+    BinaryFormatter(BinaryFormatter &&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~BinaryFormatter() override = default;
+
+    /**
+     * @brief   Assignment operator.
+     */
+    BinaryFormatter & operator=(BinaryFormatter const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    BinaryFormatter & operator=(BinaryFormatter &&) = delete;
+
+private:
+    /**
+     * @brief   The detailed formatter function to reimplement in derived classes.
+     * @param   event           the log event data.
+     * @return  The string to push to the Sink instance.
+     */
+    std::string Format_(Event const & event) override;
+
+    /**
+     * @brief   Closes the current block with an index record and starts a new one.
+     * @param   out             the buffer to append the index record to.
+     */
+    void WriteIndex(std::string & out);
+
+    /**
+     * @brief   Appends the record of an event with a templated message.
+     * @param   out             the buffer to append to.
+     * @param   head            level, logger id, thread id and time of the event.
+     * @param   message         the message of the event.
+     * @return  true, if the event has been written; false if the message is not suitable.
+     */
+    bool WriteTemplateEvent(std::string & out, std::string & head, std::string const & message);
+};
+
+
 /**
  * @brief   The standard formatter used for console sinks.
  * This is best viewed in a general dark console color scheme.
+ *
+ * All the terminal color codes around the level and logger of a line are constant for
+ * a given pair of logger and level. These are computed once, when the logger is created
+ * (see Logger::GetColorPrefixes()), so formatting an event merely appends ready-made
+ * byte ranges.
  */
 class ColorDarkBackgroundFormatter : public Formatter {
 
+public:
+    /**
+     * @brief   Creates the colored prefixes for a logger.
+     * A prefix holds everything between the time string and the message of a line: the
+     * colored level, the colored logger name and the ": " separator. There is one prefix
+     * for each level from Level::kUndefined up to Level::kDebug (in that order).
+     * @param   id          the id of the logger.
+     * @param   name        the name of the logger (empty for the root logger).
+     * @return  The colored prefixes of all levels.
+     */
+    static std::array<std::string, 6> CreatePrefixes(unsigned int id, std::string const & name);
+
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
+private:
+    /**
+     * @brief   The detailed formatter function to reimplement in derived classes.
+     * @param   event           the log event data.
+     * @return  The string to push to the Sink instance.
+     */
+    std::string Format_(Event const & event) override;
+};
+
+
+
+/**
+ * @brief   A formatter which produces Chrome trace events (JSON), e.g. for chrome://tracing or Perfetto.
+ *
+ * Trace events (see TraceEvent and ScopedTimer) become durations on the timeline of their
+ * thread; all other events become instant events with their level as argument. Each event
+ * is an element of the JSON array format, followed by a comma (the array may stay open).
+ *
+ * Example output:
+ *
+ *      {"name":"query","cat":"app.db","ph":"X","ts":1617871234000123,"dur":1200,"pid":42,"tid":4711},
+ *      {"name":"Cache miss","cat":"app.db","ph":"i","s":"t","ts":1617871234001400,"pid":42,"tid":4711,
+ *       "args":{"level":"info"}},
+ *
+ * Time stamps are microseconds since the epoch, so traces of several processes line up.
+ * Use it with "file:trace.json?format=chrome", which starts the file with '['.
+ */
+class ChromeFormatter : public Formatter {
+
+    std::string pid_;           //!< @brief The process id.
+
+public:
+    /**
+     * @brief   Constructor.
+     */
+    ChromeFormatter();
+
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
+private:
+    /**
+     * @brief   The detailed formatter function to reimplement in derived classes.
+     * @param   event           the log event data.
+     * @return  The string to push to the Sink instance.
+     */
+    std::string Format_(Event const & event) override;
+};
+
+
+/**
+ * @brief   A formatter which produces Graylog Extended Log Format (GELF 1.1) JSON.
+ *
+ * Example output (in a single line):
+ *
+ *      {"version":"1.1","host":"web-1","short_message":"Request failed","timestamp":1617871234.000123,
+ *       "level":4,"_logger":"app.http","_thread_id":4711,"_sequence":42}
+ *
+ * The level is mapped to the syslog severity (Critical: 2, Warning: 4, Info: 6, Debug: 7).
+ * A message spanning multiple lines is sent as "full_message" with its first line as
+ * "short_message".
+ *
+ * This is the formatter of the "gelf+udp://" and "gelf+tcp://" sinks.
+ */
+class GELFFormatter : public Formatter {
+
+    std::string host_;        //!< @brief The host name (JSON encoded).
+
+public:
+    /**
+     * @brief   Constructor.
+     */
+    GELFFormatter();
+
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
 private:
     /**
      * @brief   The detailed formatter function to reimplement in derived classes.
@@ -152,6 +474,39 @@ private:
 };
 
 
+/**
+ * @brief   A formatter which produces an OpenTelemetry log record (OTLP JSON).
+ *
+ * Example output (in a single line):
+ *
+ *      {"timeUnixNano":"1617871234000123000","severityNumber":13,"severityText":"warning",
+ *       "body":{"stringValue":"Request failed"},"attributes":[{"key":"logger","value":{"stringValue":"app.http"}},
+ *       {"key":"thread.id","value":{"intValue":"4711"}},{"key":"sequence","value":{"intValue":"42"}}]}
+ *
+ * The level is mapped to the OpenTelemetry severity number (Critical: FATAL 21, Warning: WARN 13,
+ * Info: INFO 9, Debug: DEBUG 5, beyond: TRACE 1).
+ *
+ * This is the formatter of the "otlp+http://" and "otlp+file:" sinks, which wrap batches of
+ * these records into export requests.
+ */
+class OTLPFormatter : public Formatter {
+
+public:
+    /**
+     * @brief   Returns the render key of this formatter.
+     * @return  The render key identifying the kind and configuration of this formatter.
+     */
+    [[nodiscard]] std::string const & GetRenderKey() const override;
+
+private:
+    /**
+     * @brief   The detailed formatter function to reimplement in derived classes.
+     * @param   event           the log event data.
+     * @return  The string to push to the Sink instance.
+     */
+    std::string Format_(Event const & event) override;
+};
+
 }
 
 
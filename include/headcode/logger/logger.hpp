@@ -9,12 +9,18 @@
 #ifndef HEADCODE_SPACE_LOGGER_LOGGER_HPP
 #define HEADCODE_SPACE_LOGGER_LOGGER_HPP
 
+#include "binary_reader.hpp"
+#include "crash.hpp"
+#include "emergency.hpp"
 #include "event.hpp"
 #include "formatter.hpp"
 #include "level.hpp"
 #include "logger_core.hpp"
+#include "scoped_timer.hpp"
+#include "shm_ring_reader.hpp"
 #include "sink.hpp"
 #include "sink_factory.hpp"
 #include "version.hpp"
+#include "worker.hpp"
 
 #endif
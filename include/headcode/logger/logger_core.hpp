@@ -9,9 +9,12 @@
 #ifndef HEADCODE_SPACE_LOGGER_LOGGER_CORE_HPP
 #define HEADCODE_SPACE_LOGGER_LOGGER_CORE_HPP
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -74,15 +77,48 @@ class Sink;         //!< @brief Forward declaration of a sink.
  *  all the sinks of the parent logger are used.
  *
  *  The root logger has the ConsoleSink as default.
+ *
+ *  Events stopped by a logger's barrier are usually lost. With a backtrace depth set (see
+ *  SetBacktraceDepth()) each thread keeps the last stopped events, unformatted, in a small ring.
+ *  As soon as the same thread logs a warning or a critical event which passes its barrier, the
+ *  held back events are pushed first, with "[backtrace] " in front of their message and marked
+ *  (see Event::IsBacktrace()). This gives the debug trail leading to a problem without paying
+ *  for debug output all the time.
+ *
+ *  Barriers and sinks may be changed at any time while other threads log. The sinks of a
+ *  logger are an immutable list: AddSink(), RemoveSink() and SetSink() publish a new list,
+ *  logging threads pick up whichever list is current without taking a lock or touching
+ *  reference counts. A change waits for the logging threads still walking the list replaced
+ *  to finish their event and frees it then.
+ *
+ *  A logger owns its sinks: a sink added stays alive and gets events until it is removed
+ *  (RemoveSink(), SetSink()), no matter who else still holds it.
  */
 class Logger {
 
-    std::string name_;                              //!< @brief The name of this logger.
-    std::list<std::string> ancestors_;              //!< @brief All names of all parent loggers in order.
-    unsigned int id_{0};                            //!< @brief An id of this logger.
-    int barrier_{0};                                //!< @brief Log level barrier (see description).
-    std::vector<std::weak_ptr<Sink>> sinks_;        //!< @brief URLs of all Sinks attached to this logger.
-    std::uint64_t events_logged_{0};                //!< @brief Number of events logged so far.
+    /**
+     * @brief   The sinks of a logger, never changed once published.
+     */
+    using SinkList = std::vector<std::shared_ptr<Sink>>;
+
+    /**
+     * @brief   A sink list replaced, waiting for the logging threads to leave it.
+     */
+    struct RetiredSinkList {
+        std::uint64_t epoch_;                           //!< @brief The epoch the list has been retired in.
+        std::unique_ptr<SinkList const> sinks_;         //!< @brief The sinks.
+    };
+
+    std::string name_;                                  //!< @brief The name of this logger.
+    std::list<std::string> ancestors_;                  //!< @brief All names of all parent loggers in order.
+    unsigned int id_{0};                                //!< @brief An id of this logger.
+    std::atomic<int> barrier_{0};                       //!< @brief Log level barrier (see description).
+    std::atomic<SinkList const *> sinks_{nullptr};      //!< @brief The current list of sinks of this logger.
+    std::unique_ptr<SinkList const> sink_list_;         //!< @brief Holds the current list of sinks.
+    std::list<RetiredSinkList> retired_sink_lists_;     //!< @brief Sink lists replaced but maybe still read.
+    std::mutex sinks_mutex_;                            //!< @brief Serializes changes of the sinks.
+    std::atomic<std::uint64_t> events_logged_{0};       //!< @brief Number of events logged so far.
+    std::array<std::string, 6> color_prefixes_;         //!< @brief Terminal colored prefixes per level.
 
 public:
     /**
@@ -112,7 +148,7 @@ public:
 
     /**
      * @brief   Adds a sink to the sinks of this logger.
-     * Avoids double adding.
+     * Avoids double adding. The logger holds the sink until it is removed again.
      * @param   sink        sink to add.
      */
     void AddSink(std::shared_ptr<Sink> sink);
@@ -144,21 +180,44 @@ public:
      * @return  The current log level barrier event levels need to pass.
      */
     [[nodiscard]] int GetBarrier() const {
-        return barrier_;
+        return barrier_.load(std::memory_order_relaxed);
     }
 
+    /**
+     * @brief   Gets the number of stopped events each thread holds back (see SetBacktraceDepth()).
+     * @return  The backtrace depth; 0 if turned off.
+     */
+    static std::size_t GetBacktraceDepth();
+
+    /**
+     * @brief   Writes out everything the sinks of this logger buffer or queue (see Sink::Flush()).
+     * If this logger has no sinks of its own, the sinks of the parent logger are flushed.
+     * @param   deadline    the latest time to return.
+     * @return  true, if all events logged so far have been written in time.
+     */
+    bool Flush(std::chrono::steady_clock::time_point deadline);
+
     /**
      * @brief   Gets the time point of birth of the logger subsystem.
      * @return  The time point when the logger subsystem came to live.
      */
     static std::chrono::system_clock::time_point GetBirth();
 
+    /**
+     * @brief   Gets the precomputed terminal colored line prefixes of this logger.
+     * See ColorDarkBackgroundFormatter::CreatePrefixes().
+     * @return  The colored line prefixes for each level from Level::kUndefined to Level::kDebug.
+     */
+    [[nodiscard]] std::array<std::string, 6> const & GetColorPrefixes() const {
+        return color_prefixes_;
+    }
+
     /**
      * @brief   Returns the number of events logged so far.
      * @return  The amount of events which passed this logger instance.
      */
     [[nodiscard]] std::uint64_t GetEventsLogged() const {
-        return events_logged_;
+        return events_logged_.load(std::memory_order_relaxed);
     }
 
     /**
@@ -201,13 +260,21 @@ public:
      */
     [[nodiscard]] std::string GetName() const;
 
+    /**
+     * @brief   Gets the name of this logger as stored: the root logger has an empty name.
+     * Unlike GetName() this does not allocate (e.g. for use in signal handlers).
+     * @return  The name of this logger.
+     */
+    [[nodiscard]] std::string const & GetRawName() const {
+        return name_;
+    }
+
     /**
      * @brief   Gets all the sinks associated with this logger.
+     * The list returned is a copy: it does not change if sinks are added or removed meanwhile.
      * @return  All the sinks of this logger.
      */
-    [[nodiscard]] std::vector<std::weak_ptr<Sink>> const & GetSinks() const {
-        return sinks_;
-    }
+    [[nodiscard]] std::vector<std::shared_ptr<Sink>> GetSinks() const;
 
     /**
      * @brief   Checks if this logger is the root logger.
@@ -224,6 +291,24 @@ public:
      */
     void Log(Event const & event);
 
+    /**
+     * @brief   Removes a sink from the sinks of this logger.
+     * An event already on its way may still reach the sink: this waits for such events to
+     * finish. Once this returns the logger holds the sink no longer and it is gone unless
+     * somebody else holds it too. Called while logging on this thread (e.g. from within a
+     * sink) this cannot wait: the logger then lets go of the sink with a later change.
+     * @param   sink        the sink to remove.
+     */
+    void RemoveSink(std::shared_ptr<Sink> const & sink);
+
+    /**
+     * @brief   Sets the number of stopped events each thread holds back for a backtrace.
+     * 0 (the default) turns backtraces off. A thread picks up the new depth with its next
+     * stopped event, dropping what it held so far.
+     * @param   depth       the new backtrace depth.
+     */
+    static void SetBacktraceDepth(std::size_t depth);
+
     /**
      * @brief   Sets a new log level barrier (see description of GetBarrier()).
      * @param   barrier     the new log level barrier for events.
@@ -238,7 +323,8 @@ public:
 
     /**
      * @brief   Sets a single Sink.
-     * This removes any previous sinks at this logger.
+     * This removes any previous sinks at this logger, see RemoveSink() for when these are
+     * released.
      * @param   sink        the sink to set.
      */
     void SetSink(std::shared_ptr<Sink> sink);
@@ -250,15 +336,46 @@ private:
      */
     explicit Logger(std::string name, unsigned int id);
 
+    /**
+     * @brief   Publishes a new list of sinks and frees lists no logging thread reads anymore.
+     * The caller holds the sinks_mutex_.
+     * @param   sinks       the new sinks of this logger.
+     */
+    void PublishSinks(SinkList sinks);
+
     /**
      * @brief   Pushed the given event to a sink.
      * The event has already passed the barrier.
      * @param   event       the event to push.
      */
     void Push(Event const & event);
+
+    /**
+     * @brief   Pushes the events held back by the current thread (see SetBacktraceDepth()).
+     */
+    static void PushBacktrace();
 };
 
 
+/**
+ * @brief   Writes out everything any sink of any logger buffers or queues.
+ *
+ * Call this before the process exits (e.g. on SIGTERM during a deploy): the destruction
+ * order of static objects is unspecified, so events still queued by then may be lost.
+ * Each sink is flushed once, even if attached to several loggers. The sinks stay usable:
+ * events logged afterwards are written as usual.
+ *
+ * Example:
+ * @code
+ *      auto done = headcode::logger::Shutdown(std::chrono::steady_clock::now() + std::chrono::seconds{5});
+ * @endcode
+ *
+ * @param   deadline    the latest time to return.
+ * @return  true, if all events logged so far have been written in time.
+ */
+bool Shutdown(std::chrono::steady_clock::time_point deadline);
+
+
 }
 
 
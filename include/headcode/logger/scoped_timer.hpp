@@ -0,0 +1,113 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SCOPED_TIMER_HPP
+#define HEADCODE_SPACE_LOGGER_SCOPED_TIMER_HPP
+
+#include "event.hpp"
+#include "level.hpp"
+
+#include <chrono>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Measures the time spent in a scope and logs it as trace event(s).
+ *
+ * By default a single complete event (TracePhase::kComplete) holding the start and the
+ * duration is logged when the timer goes out of scope. With kBeginEnd a begin event is
+ * logged at once and an end event when the timer goes out of scope: nested or long running
+ * scopes show up on the timeline even if the process dies in between.
+ *
+ * The trace events are ordinary events (Debug by default) passing the logger's barrier: turn
+ * on the logger to profile a subsystem. Write them with a "file:trace.json?format=chrome" sink
+ * (see ChromeFormatter) and load the file in chrome://tracing or Perfetto.
+ *
+ * Example:
+ * @code
+ *      void Query() {
+ *          headcode::logger::ScopedTimer timer{"app.db", "query"};
+ *          ...
+ *      }
+ * @endcode
+ */
+class ScopedTimer {
+
+public:
+    /**
+     * @brief   Events logged by the timer.
+     */
+    enum class Mode {
+        kComplete,      //!< @brief A single complete event at the end of the scope.
+        kBeginEnd       //!< @brief A begin event at once, an end event at the end of the scope.
+    };
+
+private:
+    std::string logger_name_;                                   //!< @brief The logger of the events.
+    std::string name_;                                          //!< @brief The name of the duration.
+    Level level_;                                               //!< @brief The level of the events.
+    Mode mode_;                                                 //!< @brief Events logged.
+    std::chrono::system_clock::time_point start_;               //!< @brief Wall clock time of the start.
+    std::chrono::steady_clock::time_point steady_start_;        //!< @brief Monotonic time of the start.
+
+public:
+    /**
+     * @brief   Constructor: starts the timer.
+     * @param   logger_name         The name of the logger the events are addressed to.
+     * @param   name                The name of the duration.
+     * @param   level               The level of the events.
+     * @param   mode                The events logged.
+     */
+    ScopedTimer(std::string logger_name, std::string name, Level level = Level::kDebug, Mode mode = Mode::kComplete);
+
+    /**
+     * @brief   Copy constructor.
+     */
+    ScopedTimer(ScopedTimer const &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    ScopedTimer(ScopedTimer &&) = delete;
+
+    /**
+     * @brief   Destructor: logs the end of the duration.
+     */
+    ~ScopedTimer() noexcept;
+
+    /**
+     * @brief   Assignment operator.
+     */
+    ScopedTimer & operator=(ScopedTimer const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    ScopedTimer & operator=(ScopedTimer &&) = delete;
+
+    /**
+     * @brief   Gets the time passed since the timer started.
+     * @return  The time passed so far.
+     */
+    [[nodiscard]] std::chrono::microseconds GetElapsed() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                     steady_start_);
+    }
+};
+
+
+}
+
+
+#endif
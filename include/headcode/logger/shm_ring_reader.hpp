@@ -0,0 +1,123 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SHM_RING_READER_HPP
+#define HEADCODE_SPACE_LOGGER_SHM_RING_READER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+class ShmRing;        //!< @brief Forward declaration of the mapped ring.
+
+
+/**
+ * @brief   Drains the shared memory ring of a "shm:" sink.
+ *
+ * Applications log into a ring buffer in shared memory ("shm:app"). Another
+ * process (see the `hcs-logcollect` tool) reads the ring with this class and does the
+ * actual I/O. Writers never wait for the reader: if the reader falls behind, writers
+ * overwrite the oldest slots, which the reader notices and counts as lost.
+ *
+ * There must be only one reader per ring. The read position is kept in the ring, so
+ * a restarted reader continues where the previous one stopped.
+ *
+ * Example:
+ * @code
+ *      headcode::logger::ShmRingReader reader{"app"};
+ *      std::string record;
+ *      while (reader.IsOpen()) {
+ *          while (reader.Next(record)) {
+ *              std::cout << record;
+ *          }
+ *          std::this_thread::sleep_for(std::chrono::milliseconds{10});
+ *      }
+ * @endcode
+ */
+class ShmRingReader {
+
+    std::unique_ptr<ShmRing> ring_;        //!< @brief The mapped ring.
+    std::uint64_t position_{0};            //!< @brief The next ticket to read.
+    std::uint64_t lost_{0};                //!< @brief Number of slots lost so far.
+    std::string partial_;                  //!< @brief The parts read so far of a record spanning slots.
+    bool in_record_{false};                //!< @brief partial_ holds the start of a record.
+
+public:
+    /**
+     * @brief   Constructor. Maps the ring if it exists.
+     * @param   name        the name of the ring as given in the "shm:" URL (e.g. "app").
+     */
+    explicit ShmRingReader(std::string const & name);
+
+    /**
+     * @brief   Copy constructor.
+     */
+    ShmRingReader(ShmRingReader const &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    ShmRingReader(ShmRingReader &&) = delete;
+
+    /**
+     * @brief   Destructor.
+     */
+    ~ShmRingReader();
+
+    /**
+     * @brief   Assignment operator.
+     */
+    ShmRingReader & operator=(ShmRingReader const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    ShmRingReader & operator=(ShmRingReader &&) = delete;
+
+    /**
+     * @brief   Gets the number of slots lost, because writers overwrote them before they were read.
+     * Most records need a single slot only, so this is about the number of records lost.
+     * @return  The number of slots lost so far.
+     */
+    [[nodiscard]] std::uint64_t GetLost() const {
+        return lost_;
+    }
+
+    /**
+     * @brief   Checks if the ring has been mapped.
+     * @return  true, if the ring exists and is valid.
+     */
+    [[nodiscard]] bool IsOpen() const;
+
+    /**
+     * @brief   Reads the next record (one formatted event).
+     * @param   record      receives the record.
+     * @return  true, if a record has been read; false if there is none (yet).
+     */
+    bool Next(std::string & record);
+
+    /**
+     * @brief   Removes the shared memory object of a ring.
+     * Processes which have mapped the ring keep it until they unmap it.
+     * @param   name        the name of the ring as given in the "shm:" URL (e.g. "app").
+     */
+    static void Unlink(std::string const & name);
+};
+
+
+}
+
+
+#endif
@@ -11,8 +11,13 @@
 
 #include "level.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 
@@ -38,6 +43,15 @@ class Formatter;        //!< @brief Forward declaration of a formatter.
  *  - "stderr:"                     A console sink which writes to stderr.
  *  - "file:///path/to/a/file"      A sink which writes into a file (add authority and path to this url if needed).
  *  - "syslog:"                     A sink which writes to syslog.
+ *  - "journal:"                    A sink which sends events to the systemd journal (native protocol).
+ *  - "shm:name"                    A sink which writes into a shared memory ring (see ShmRingReader).
+ *  - "ring:?target=stderr:"        A sink which keeps the last events in memory and writes them to
+ *                                  the target on Critical events, on Dump() or on a crash.
+ *  - "udp://host:port"             A sink which sends events as UDP datagrams.
+ *  - "tcp://host:port"             A sink which streams events over a TCP connection.
+ *  - "unix:/path/to/socket"        A sink which writes events to a local agent over a unix domain socket.
+ *  - "otlp+http://host:port/path"  A sink which exports events in batches to an OpenTelemetry collector.
+ *  - "otlp+file:path"              A sink which exports events in batches to an OTLP JSON-lines file.
  *
  * Examples:
  * @code
@@ -68,10 +82,18 @@ class Formatter;        //!< @brief Forward declaration of a formatter.
  */
 class Sink {
 
-    std::string url_;                                     //!< @brief The URL of this sink.
-    int barrier_{static_cast<int>(Level::kDebug)};        //!< @brief Log level barrier (see description).
-    std::unique_ptr<Formatter> formatter_;                //!< @brief The formatter used for this sink.
-    std::uint64_t events_logged_{0};                      //!< @brief Number of events logged so far.
+    /**
+     * @brief   A formatter replaced, with the epoch it has been retired in (see SetFormatter()).
+     */
+    using RetiredFormatter = std::pair<std::uint64_t, std::shared_ptr<Formatter const>>;
+
+    std::string url_;                                            //!< @brief The URL of this sink.
+    std::atomic<int> barrier_{static_cast<int>(Level::kDebug)};  //!< @brief Log level barrier (see description).
+    std::atomic<Formatter *> formatter_{nullptr};                //!< @brief The formatter used for this sink.
+    std::shared_ptr<Formatter const> current_formatter_;         //!< @brief Holds the current formatter.
+    std::list<RetiredFormatter> retired_formatters_;             //!< @brief Formatters replaced but maybe in use.
+    mutable std::mutex formatters_mutex_;                        //!< @brief Guards changes of the formatter.
+    std::atomic<std::uint64_t> events_logged_{0};                //!< @brief Number of events logged so far.
 
 public:
     /**
@@ -82,7 +104,7 @@ public:
     /**
      * @brief   Move constructor
      */
-    Sink(Sink &&) = default;
+    Sink(Sink &&) = delete;
 
     /**
      * @brief   Destructor
@@ -97,14 +119,30 @@ public:
     /**
      * @brief   Move operator.
      */
-    Sink & operator=(Sink &&) = default;
+    Sink & operator=(Sink &&) = delete;
+
+    /**
+     * @brief   Writes out events held back by this sink (e.g. the events in a "ring:" sink).
+     * Most sinks hold back nothing and do nothing here.
+     */
+    void Dump();
+
+    /**
+     * @brief   Writes out everything this sink buffers or queues, waiting at most until the deadline.
+     * Sinks configured to do so also sync their files to stable storage (e.g. "file:...?sync=flush").
+     * Events held back on purpose (like the ones in a "ring:" sink) are not written.
+     * @param   deadline    the latest time to return.
+     * @return  true, if all events logged so far have been written.
+     */
+    bool Flush(std::chrono::steady_clock::time_point deadline);
 
     /**
      * @brief   Applies the sink's formatter to the event message.
+     * Sinks with formatters of the same render key share the very same text (see Formatter::Format).
      * @param   event       the event to produce a message from.
-     * @return  The final string to push.
+     * @return  The final string to push (valid as long as the event lives).
      */
-    std::string Format(Event const & event);
+    std::string const & Format(Event const & event);
 
     /**
      * @brief   Gets the log level barrier.
@@ -124,7 +162,7 @@ public:
      * @return  The current log level barrier event levels need to pass.
      */
     [[nodiscard]] int GetBarrier() const {
-        return barrier_;
+        return barrier_.load(std::memory_order_relaxed);
     }
 
     /**
@@ -138,16 +176,15 @@ public:
      * @return  The amount of events which passed this logger instance.
      */
     [[nodiscard]] std::uint64_t GetEventsLogged() const {
-        return events_logged_;
+        return events_logged_.load(std::memory_order_relaxed);
     }
 
     /**
      * @brief   Returns the formatter of this sink.
-     * @return  The Formatter instance of this link.
+     * The formatter returned stays alive even if SetFormatter() replaces it meanwhile.
+     * @return  The Formatter instance of this sink.
      */
-    [[nodiscard]] Formatter const & GetFormatter() const {
-        return *(formatter_.get());
-    }
+    [[nodiscard]] std::shared_ptr<Formatter const> GetFormatter() const;
 
     /**
      * @brief   Retrieves the URL of this sink.
@@ -177,7 +214,11 @@ public:
 
     /**
      * @brief   Sets the formatter of this sink.
-     * A nullptr is not accepted and refused to been applied.
+     * A nullptr is not accepted and refused to been applied. This may be called while other
+     * threads log: events being formatted right now still use the old formatter, this waits
+     * for them. Once this returns the sink holds the old formatter and its state no longer
+     * (GetFormatter() callers may still). Called while logging on this thread (e.g. from
+     * within a sink) this cannot wait: the old formatter is then freed with a later change.
      * @param   formatter       the new formatter of this sink.
      */
     void SetFormatter(std::unique_ptr<Formatter> && formatter);
@@ -198,6 +239,22 @@ protected:
     }
 
 private:
+    /**
+     * @brief   Writes out events held back by this sink.
+     */
+    virtual void Dump_() {
+    }
+
+    /**
+     * @brief   Writes out everything this sink buffers or queues.
+     * Most sinks write each event at once and do nothing here.
+     * @param   deadline    the latest time to return.
+     * @return  true, if all events logged so far have been written.
+     */
+    virtual bool Flush_([[maybe_unused]] std::chrono::steady_clock::time_point deadline) {
+        return true;
+    }
+
     /**
      * @brief   Gets the sink description.
      * @return  A human readable description of this sink.
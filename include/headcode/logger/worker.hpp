@@ -0,0 +1,87 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_WORKER_HPP
+#define HEADCODE_SPACE_LOGGER_WORKER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   How the threads the logger starts for background work run.
+ *
+ * Some sinks do their I/O on worker threads of their own: the queueing sinks ("udp://",
+ * "tcp://", "otlp+http://", ...) and files synced periodically ("file:...?sync=periodic").
+ * Each worker is named by its prefix plus its kind (e.g. "hcs-udp", see ps -L or top -H),
+ * may be kept off CPUs reserved for latency critical threads and may run with a lower
+ * priority or another scheduling policy.
+ *
+ * A worker of a queueing sink out of work first spins, then yields the CPU, then sleeps on
+ * a futex. Logging threads only enter the kernel to wake a sleeping worker. Spinning and
+ * yielding cut the latency of records coming in after a quiet moment but burn CPU time
+ * while idle: by default workers sleep at once, which suits most deployments.
+ *
+ * Example:
+ * @code
+ *      headcode::logger::WorkerSettings settings;
+ *      settings.cpus = {0, 1};                 // keep off the isolated cores 2 and up
+ *      settings.nice = 10;
+ *      settings.spin = std::chrono::microseconds{50};
+ *      headcode::logger::SetWorkerSettings(settings);
+ * @endcode
+ */
+struct WorkerSettings {
+    std::vector<unsigned int> cpus;          //!< @brief CPUs the workers run on; empty: as the thread starting them.
+    std::string name_prefix{"hcs-"};         //!< @brief Prefix of the thread names (cut off at 15 characters).
+    int nice{0};                             //!< @brief Nice value (for SCHED_OTHER and SCHED_BATCH).
+    int policy{0};                           //!< @brief Scheduling policy (SCHED_OTHER, SCHED_BATCH, SCHED_FIFO...).
+    int priority{0};                         //!< @brief Static priority (for SCHED_FIFO and SCHED_RR).
+    std::chrono::microseconds spin{0};       //!< @brief Time an idle worker spins before yielding.
+    std::chrono::microseconds yield{0};      //!< @brief Time an idle worker yields before sleeping.
+};
+
+
+/**
+ * @brief   Gets the settings of the worker threads.
+ * @return  The current worker settings.
+ */
+WorkerSettings GetWorkerSettings();
+
+
+/**
+ * @brief   Gets the number of worker threads running.
+ * There is one worker per queueing sink and one per file synced periodically.
+ * @return  The number of worker threads.
+ */
+std::size_t GetWorkerCount();
+
+
+/**
+ * @brief   Sets the settings of the worker threads.
+ * The settings apply to all workers started from now on and to the ones running. An empty
+ * CPU list leaves the affinity of running workers as it is. Real-time policies and
+ * negative nice values need privileges (CAP_SYS_NICE).
+ * @param   settings    the new worker settings.
+ * @return  true, if the settings have been applied to all running workers.
+ */
+bool SetWorkerSettings(WorkerSettings settings);
+
+
+}
+
+
+#endif
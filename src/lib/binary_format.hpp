@@ -0,0 +1,306 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_BINARY_FORMAT_HPP
+#define HEADCODE_SPACE_LOGGER_BINARY_FORMAT_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+/**
+ * @brief   The binary log format.
+ *
+ * A binary log is a sequence of records. Each record is made of
+ *
+ *      varint      record type
+ *      varint      size of the payload in bytes
+ *      bytes       payload
+ *
+ * All integers are unsigned LEB128 variable length integers. Signed values are zig-zag
+ * encoded beforehand. Readers skip records of unknown type.
+ *
+ * Record payloads:
+ *
+ *      kHeader:    "HCSL" (4 bytes), varint version, varint time (microseconds since epoch)
+ *      kLogger:    varint logger id, bytes logger name (empty for the root logger)
+ *      kEvent:     varint level (zig-zag), varint logger id, varint thread id,
+ *                  varint time (zig-zag, microseconds since the previous record), bytes message
+ *      kIndex:     varint base time, varint earliest time, varint latest time, varint end time
+ *                  (all microseconds since epoch),
+ *                  varint lowest level (zig-zag), varint highest level (zig-zag), varint number of events,
+ *                  varint block size, varint number of loggers, {varint name size, bytes name}...,
+ *                  4 bytes record size (little endian, from record type up to the end), "HCSX"
+ *      kTemplate:  varint template id, bytes template (each parameter is marked by a '\0')
+ *      kTemplateEvent:
+ *                  varint level (zig-zag), varint logger id, varint thread id,
+ *                  varint time (zig-zag, microseconds since the previous record),
+ *                  varint template id, {parameter}... (one for each '\0' of the template)
+ *
+ * A parameter is a varint tag: with the lowest bit clear the tag holds a number (tag >> 1)
+ * without leading zeros, else the tag holds the size (tag >> 1) of the parameter bytes which
+ * follow. Decoding a kTemplateEvent replaces each '\0' of the template with its parameter.
+ *
+ * A header starts a new session: the logger dictionary is cleared and the time set. Logger
+ * records always precede the first event of the logger within a session.
+ *
+ * An index record closes a block: all the records written since the previous index record
+ * (or the start of the session). The block size is the number of bytes of these. After an
+ * index record the logger dictionary is cleared again, so each block carries all the logger
+ * records it needs. The base time is the time before the first event of the block; decoding
+ * a block on its own starts from there. The end time is the time of the last event written,
+ * hence the base time of the next block. Events are not written in the order of their time
+ * (e.g. concurrent threads or replays), so the earliest and latest time of a block bound its
+ * events, not the first and last event. As the record ends with a fixed size trailer, index
+ * records can be found from the end of a file: at the end of a block the trailer tells where
+ * its index record starts, which tells where the block starts, which is where the previous
+ * index record ends.
+ *
+ * Template records work like logger records: they are cleared by headers and index records
+ * and always precede the first event using them.
+ */
+namespace headcode::logger::binary {
+
+
+/**
+ * @brief   The types of records.
+ */
+enum class RecordType : std::uint64_t {
+    kHeader = 1,               //!< @brief Start of a session.
+    kLogger = 2,               //!< @brief Logger dictionary entry.
+    kEvent = 3,                //!< @brief A log event.
+    kIndex = 4,                //!< @brief Summary of a block.
+    kTemplate = 5,             //!< @brief Message template dictionary entry.
+    kTemplateEvent = 6         //!< @brief A log event with a templated message.
+};
+
+
+/**
+ * @brief   Magic bytes of the header.
+ */
+static constexpr char const kMagic[] = "HCSL";
+
+
+/**
+ * @brief   Magic bytes at the very end of an index record.
+ */
+static constexpr char const kIndexMagic[] = "HCSX";
+
+
+/**
+ * @brief   Size of the trailer of an index record: 4 bytes record size and 4 bytes magic.
+ */
+static constexpr std::size_t kIndexTrailerSize = 8;
+
+
+/**
+ * @brief   Version of the binary log format.
+ */
+static constexpr std::uint64_t kVersion = 2;
+
+
+/**
+ * @brief   Version of the binary log format without templates.
+ * Logs without any template record are written with this version, so older readers still cope.
+ */
+static constexpr std::uint64_t kVersionPlain = 1;
+
+
+/**
+ * @brief   Marks a parameter within a template.
+ */
+static constexpr char kTemplateParameter = '\0';
+
+
+/**
+ * @brief   Longest number (in digits) stored as varint parameter.
+ */
+static constexpr std::size_t kMaxNumberDigits = 18;
+
+
+/**
+ * @brief   Maximum size of a single record payload we accept when reading.
+ */
+static constexpr std::uint64_t kMaxPayloadSize = 64 * 1024 * 1024;
+
+
+/**
+ * @brief   Zig-zag encodes a signed value.
+ * @param   value       the signed value.
+ * @return  The zig-zag encoded value.
+ */
+inline std::uint64_t ZigZagEncode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+
+/**
+ * @brief   Zig-zag decodes a signed value.
+ * @param   value       the zig-zag encoded value.
+ * @return  The signed value.
+ */
+inline std::int64_t ZigZagDecode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+
+/**
+ * @brief   Appends a variable length integer.
+ * @param   out         the buffer to append to.
+ * @param   value       the value to append.
+ */
+inline void PutVarint(std::string & out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+
+/**
+ * @brief   Reads a variable length integer.
+ * @param   pos         the current read position (advanced).
+ * @param   end         the end of the data.
+ * @param   value       the value read.
+ * @return  true, if a complete value has been read.
+ */
+inline bool GetVarint(char const *& pos, char const * end, std::uint64_t & value) {
+    value = 0;
+    for (unsigned int shift = 0; (pos < end) && (shift < 64); shift += 7) {
+        auto byte = static_cast<std::uint8_t>(*pos++);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief   Gets the number of bytes a variable length integer needs.
+ * @param   value       the value.
+ * @return  The size of the value encoded.
+ */
+inline std::size_t GetVarintSize(std::uint64_t value) {
+    std::size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+
+/**
+ * @brief   Splits a message into a template and its parameters.
+ *
+ * Each run of decimal digits in the message becomes a parameter.
+ *
+ * @param   message     the message.
+ * @param   tmpl        receives the template.
+ * @param   parameters  receives the encoded parameters.
+ * @return  true, if the message can be templated (i.e. it holds no '\0').
+ */
+inline bool SplitTemplate(std::string_view message, std::string & tmpl, std::string & parameters) {
+
+    tmpl.clear();
+    parameters.clear();
+    if (message.find(kTemplateParameter) != std::string_view::npos) {
+        return false;
+    }
+
+    for (std::size_t pos = 0; pos < message.size();) {
+
+        if ((message[pos] < '0') || (message[pos] > '9')) {
+            tmpl.push_back(message[pos++]);
+            continue;
+        }
+
+        auto start = pos;
+        while ((pos < message.size()) && (message[pos] >= '0') && (message[pos] <= '9')) {
+            ++pos;
+        }
+        auto digits = message.substr(start, pos - start);
+
+        tmpl.push_back(kTemplateParameter);
+        if ((digits.size() <= kMaxNumberDigits) && ((digits.size() == 1) || (digits[0] != '0'))) {
+            std::uint64_t value = 0;
+            for (auto c : digits) {
+                value = value * 10 + static_cast<std::uint64_t>(c - '0');
+            }
+            PutVarint(parameters, value << 1);
+        } else {
+            PutVarint(parameters, (digits.size() << 1) | 1);
+            parameters.append(digits);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief   Joins a template and its parameters to the message.
+ * @param   tmpl        the template.
+ * @param   pos         the current read position of the parameters (advanced).
+ * @param   end         the end of the parameters.
+ * @param   message     receives the message.
+ * @return  true, if all parameters have been read.
+ */
+inline bool JoinTemplate(std::string const & tmpl, char const *& pos, char const * end, std::string & message) {
+
+    message.clear();
+    for (auto c : tmpl) {
+
+        if (c != kTemplateParameter) {
+            message.push_back(c);
+            continue;
+        }
+
+        std::uint64_t tag = 0;
+        if (!GetVarint(pos, end, tag)) {
+            return false;
+        }
+        if ((tag & 1) == 0) {
+            message.append(std::to_string(tag >> 1));
+            continue;
+        }
+
+        auto size = tag >> 1;
+        if (size > static_cast<std::uint64_t>(end - pos)) {
+            return false;
+        }
+        message.append(pos, size);
+        pos += size;
+    }
+
+    return pos == end;
+}
+
+
+/**
+ * @brief   Appends a record.
+ * @param   out         the buffer to append to.
+ * @param   type        the record type.
+ * @param   head        the first part of the payload.
+ * @param   tail        the second part of the payload (e.g. the message bytes).
+ */
+inline void PutRecord(std::string & out, RecordType type, std::string const & head, std::string const & tail = {}) {
+    PutVarint(out, static_cast<std::uint64_t>(type));
+    PutVarint(out, head.size() + tail.size());
+    out.append(head).append(tail);
+}
+
+
+}
+
+
+#endif
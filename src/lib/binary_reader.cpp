@@ -0,0 +1,397 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/binary_reader.hpp>
+
+#include "binary_format.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+using namespace headcode::logger;
+using namespace headcode::logger::binary;
+
+
+/**
+ * @brief   Reads a variable length integer from a stream.
+ * @param   in          the stream to read from.
+ * @param   value       the value read.
+ * @return  true, if a complete value has been read.
+ */
+static bool ReadVarint(std::istream & in, std::uint64_t & value) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        auto c = in.get();
+        if (c == std::istream::traits_type::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief   Turns microseconds since epoch into a time point.
+ * @param   microseconds        microseconds since epoch.
+ * @return  The time point.
+ */
+static std::chrono::system_clock::time_point ToTimePoint(std::int64_t microseconds) {
+    return std::chrono::system_clock::time_point{
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds{microseconds})};
+}
+
+
+/**
+ * @brief   Turns a time point into microseconds since epoch.
+ * @param   time_point          the time point.
+ * @return  Microseconds since epoch.
+ */
+static std::int64_t ToMicroseconds(std::chrono::system_clock::time_point time_point) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time_point.time_since_epoch()).count();
+}
+
+
+/**
+ * @brief   Parses the payload of an index record (without the trailer).
+ * @param   pos         start of the payload.
+ * @param   end         end of the payload (start of the trailer).
+ * @param   block       receives the summary of the block.
+ * @return  true, if the payload is well formed.
+ */
+static bool ParseIndex(char const * pos, char const * end, BinaryBlock & block) {
+
+    std::uint64_t base = 0;
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    std::uint64_t end_time = 0;
+    std::uint64_t min_level = 0;
+    std::uint64_t max_level = 0;
+    std::uint64_t loggers = 0;
+    if (!GetVarint(pos, end, base) || !GetVarint(pos, end, first) || !GetVarint(pos, end, last) ||
+        !GetVarint(pos, end, end_time) || !GetVarint(pos, end, min_level) || !GetVarint(pos, end, max_level) ||
+        !GetVarint(pos, end, block.events) || !GetVarint(pos, end, block.size) || !GetVarint(pos, end, loggers)) {
+        return false;
+    }
+
+    block.loggers.clear();
+    for (std::uint64_t i = 0; i < loggers; ++i) {
+        std::uint64_t size = 0;
+        if (!GetVarint(pos, end, size) || (size > static_cast<std::uint64_t>(end - pos))) {
+            return false;
+        }
+        block.loggers.emplace_back(pos, size);
+        pos += size;
+    }
+
+    block.base = ToTimePoint(static_cast<std::int64_t>(base));
+    block.first = ToTimePoint(static_cast<std::int64_t>(first));
+    block.last = ToTimePoint(static_cast<std::int64_t>(last));
+    block.end = ToTimePoint(static_cast<std::int64_t>(end_time));
+    block.min_level = static_cast<int>(ZigZagDecode(min_level));
+    block.max_level = static_cast<int>(ZigZagDecode(max_level));
+
+    return pos == end;
+}
+
+
+/**
+ * @brief   Reads bytes at a certain position of a stream.
+ * @param   in          the stream.
+ * @param   offset      the position to read from.
+ * @param   buffer      receives the bytes.
+ * @param   size        the number of bytes to read.
+ * @return  true, if all bytes have been read.
+ */
+static bool ReadAt(std::istream & in, std::uint64_t offset, char * buffer, std::size_t size) {
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(offset));
+    return static_cast<bool>(in.read(buffer, static_cast<std::streamsize>(size)));
+}
+
+
+/**
+ * @brief   Tries to read an index record which ends at a certain position.
+ * @param   in          the stream.
+ * @param   end         the position right after the index record.
+ * @param   block       receives the block closed by the index record.
+ * @return  true, if there is a valid index record ending at that position.
+ */
+static bool ReadIndexEndingAt(std::istream & in, std::uint64_t end, BinaryBlock & block) {
+
+    char trailer[kIndexTrailerSize];
+    if ((end < kIndexTrailerSize) || !ReadAt(in, end - kIndexTrailerSize, trailer, kIndexTrailerSize) ||
+        (std::memcmp(trailer + 4, kIndexMagic, 4) != 0)) {
+        return false;
+    }
+
+    std::uint64_t record_size = 0;
+    for (unsigned int i = 0; i < 4; ++i) {
+        record_size |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(trailer[i])) << (i * 8);
+    }
+    if ((record_size <= kIndexTrailerSize) || (record_size > end) || (record_size > kMaxPayloadSize)) {
+        return false;
+    }
+
+    std::string record(record_size, '\0');
+    if (!ReadAt(in, end - record_size, record.data(), record.size())) {
+        return false;
+    }
+
+    char const * pos = record.data();
+    char const * record_end = record.data() + record.size();
+    std::uint64_t type = 0;
+    std::uint64_t size = 0;
+    if (!GetVarint(pos, record_end, type) || (type != static_cast<std::uint64_t>(RecordType::kIndex)) ||
+        !GetVarint(pos, record_end, size) || (size != static_cast<std::uint64_t>(record_end - pos))) {
+        return false;
+    }
+    if (!ParseIndex(pos, record_end - kIndexTrailerSize, block) || (block.size > end - record_size)) {
+        return false;
+    }
+
+    // the block as seen by the reader includes its index record
+    block.offset = end - record_size - block.size;
+    block.size += record_size;
+    block.indexed = true;
+    block.session = block.offset > 0;
+
+    return true;
+}
+
+
+/**
+ * @brief   Searches backwards for the last index record ending at or before a position.
+ * @param   in          the stream.
+ * @param   pos         the position to search backwards from.
+ * @param   block       receives the block closed by the index record found.
+ * @return  The position right after the index record found, or 0 if there is none.
+ */
+static std::uint64_t FindIndexBefore(std::istream & in, std::uint64_t pos, BinaryBlock & block) {
+
+    static constexpr std::uint64_t kChunkSize = 64 * 1024;
+    static std::string_view const magic{kIndexMagic, 4};
+
+    std::string chunk;
+    auto chunk_end = pos;
+    while (chunk_end >= magic.size()) {
+
+        auto chunk_start = chunk_end > kChunkSize ? chunk_end - kChunkSize : 0;
+        chunk.resize(chunk_end - chunk_start);
+        if (!ReadAt(in, chunk_start, chunk.data(), chunk.size())) {
+            return 0;
+        }
+
+        auto found = std::string_view{chunk}.rfind(magic);
+        while (found != std::string_view::npos) {
+            if (ReadIndexEndingAt(in, chunk_start + found + magic.size(), block)) {
+                return chunk_start + found + magic.size();
+            }
+            found = (found == 0) ? std::string_view::npos : std::string_view{chunk}.rfind(magic, found - 1);
+        }
+
+        if (chunk_start == 0) {
+            break;
+        }
+
+        // overlap a bit, so we find a magic crossing chunk borders
+        chunk_end = chunk_start + magic.size() - 1;
+    }
+
+    return 0;
+}
+
+
+std::vector<BinaryBlock> BinaryReader::LoadIndex(std::istream & in) {
+
+    std::vector<BinaryBlock> res;
+
+    in.clear();
+    in.seekg(0, std::ios::end);
+    auto size = in.tellg();
+    if (size <= 0) {
+        in.clear();
+        return res;
+    }
+
+    // collect backwards: follow the chain of index records and search if the chain breaks
+    auto pos = static_cast<std::uint64_t>(size);
+    while (pos > 0) {
+
+        BinaryBlock block;
+        auto end = FindIndexBefore(in, pos, block);
+        if (end < pos) {
+            BinaryBlock unindexed;
+            unindexed.offset = end;
+            unindexed.size = pos - end;
+            unindexed.session = end > 0;
+            res.push_back(unindexed);
+        }
+        if (end == 0) {
+            break;
+        }
+
+        do {
+            res.push_back(block);
+            pos = block.offset;
+        } while ((pos > 0) && ReadIndexEndingAt(in, pos, block));
+    }
+
+    std::reverse(res.begin(), res.end());
+
+    // blocks without an index continue right after an indexed block
+    for (std::size_t i = 1; i < res.size(); ++i) {
+        if (!res[i].indexed && res[i].session) {
+            res[i].base = res[i - 1].end;
+        }
+    }
+
+    in.clear();
+    in.seekg(0);
+
+    return res;
+}
+
+
+bool BinaryReader::Next(BinaryRecord & record) {
+
+    while (!error_) {
+
+        if (limit_ != std::numeric_limits<std::uint64_t>::max()) {
+            auto position = in_.tellg();
+            if ((position < 0) || (static_cast<std::uint64_t>(position) >= limit_)) {
+                return false;
+            }
+        }
+
+        std::uint64_t type = 0;
+        std::uint64_t size = 0;
+        if (!ReadVarint(in_, type)) {
+            // regular end of data
+            return false;
+        }
+        if (!ReadVarint(in_, size) || (size > kMaxPayloadSize)) {
+            error_ = true;
+            return false;
+        }
+
+        std::string payload(size, '\0');
+        if (!in_.read(payload.data(), static_cast<std::streamsize>(size))) {
+            error_ = true;
+            return false;
+        }
+        char const * pos = payload.data();
+        char const * end = payload.data() + payload.size();
+
+        switch (static_cast<RecordType>(type)) {
+
+            case RecordType::kHeader: {
+                std::uint64_t version = 0;
+                std::uint64_t time = 0;
+                if ((size < 4) || (std::memcmp(pos, kMagic, 4) != 0)) {
+                    error_ = true;
+                    return false;
+                }
+                pos += 4;
+                if (!GetVarint(pos, end, version) || (version > kVersion) || !GetVarint(pos, end, time)) {
+                    error_ = true;
+                    return false;
+                }
+                header_read_ = true;
+                last_time_ = static_cast<std::int64_t>(time);
+                loggers_.clear();
+                templates_.clear();
+                break;
+            }
+
+            case RecordType::kLogger: {
+                std::uint64_t id = 0;
+                if (!header_read_ || !GetVarint(pos, end, id)) {
+                    error_ = true;
+                    return false;
+                }
+                loggers_[id] = std::string{pos, end};
+                break;
+            }
+
+            case RecordType::kTemplate: {
+                std::uint64_t id = 0;
+                if (!header_read_ || !GetVarint(pos, end, id)) {
+                    error_ = true;
+                    return false;
+                }
+                templates_[id] = std::string{pos, end};
+                break;
+            }
+
+            case RecordType::kEvent:
+            case RecordType::kTemplateEvent: {
+                std::uint64_t level = 0;
+                std::uint64_t id = 0;
+                std::uint64_t delta = 0;
+                if (!header_read_ || !GetVarint(pos, end, level) || !GetVarint(pos, end, id) ||
+                    !GetVarint(pos, end, record.thread_id) || !GetVarint(pos, end, delta)) {
+                    error_ = true;
+                    return false;
+                }
+                if (static_cast<RecordType>(type) == RecordType::kEvent) {
+                    record.message.assign(pos, end);
+                } else {
+                    std::uint64_t template_id = 0;
+                    if (!GetVarint(pos, end, template_id)) {
+                        error_ = true;
+                        return false;
+                    }
+                    auto tmpl = templates_.find(template_id);
+                    if ((tmpl == templates_.end()) || !JoinTemplate(tmpl->second, pos, end, record.message)) {
+                        error_ = true;
+                        return false;
+                    }
+                }
+                last_time_ += ZigZagDecode(delta);
+                record.time_point = ToTimePoint(last_time_);
+                record.level = static_cast<int>(ZigZagDecode(level));
+                auto iter = loggers_.find(id);
+                record.logger = iter != loggers_.end() ? iter->second : std::string{};
+                return true;
+            }
+
+            case RecordType::kIndex: {
+                BinaryBlock block;
+                if (header_read_ && (size >= kIndexTrailerSize) && ParseIndex(pos, end - kIndexTrailerSize, block)) {
+                    last_time_ = ToMicroseconds(block.end);
+                    loggers_.clear();
+                    templates_.clear();
+                }
+                break;
+            }
+
+            default:
+                // unknown record: skip
+                break;
+        }
+    }
+
+    return false;
+}
+
+
+void BinaryReader::Seek(BinaryBlock const & block) {
+    in_.clear();
+    in_.seekg(static_cast<std::streamoff>(block.offset));
+    error_ = false;
+    header_read_ = block.session;
+    last_time_ = ToMicroseconds(block.base);
+    loggers_.clear();
+    templates_.clear();
+    limit_ = block.offset + block.size;
+}
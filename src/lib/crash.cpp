@@ -0,0 +1,244 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/crash.hpp>
+
+#include "crash_registry.hpp"
+
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   A registered crash flusher.
+ */
+struct CrashFlusherEntry {
+    std::atomic<void *> context_{nullptr};                //!< @brief The context; nullptr if the entry is free.
+    std::atomic<CrashFlusher> flusher_{nullptr};          //!< @brief The function to call.
+};
+
+
+/**
+ * @brief   Maximum number of crash flushers.
+ */
+static constexpr std::size_t kMaxCrashFlushers = 64;
+
+
+/**
+ * @brief   All crash flushers.
+ */
+static std::array<CrashFlusherEntry, kMaxCrashFlushers> crash_flushers;
+
+
+/**
+ * @brief   The fatal signals we catch.
+ */
+static constexpr std::array<int, 5> kFatalSignals{SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+
+
+/**
+ * @brief   Time to write out events on a crash in milliseconds.
+ */
+static std::atomic<std::int64_t> crash_budget{1000};
+
+
+/**
+ * @brief   End of the time to write out events (monotonic milliseconds); 0 if not crashed.
+ */
+static std::atomic<std::int64_t> crash_deadline{0};
+
+
+/**
+ * @brief   The fatal signal caught.
+ */
+static std::atomic<int> crash_signal{0};
+
+
+/**
+ * @brief   The crash handler has been installed.
+ */
+static std::atomic<bool> crash_handler_installed{false};
+
+
+/**
+ * @brief   Size of the alternate signal stack of a thread.
+ */
+static constexpr std::size_t kAlternateStackSize = 64 * 1024;
+
+
+/**
+ * @brief   The alternate signal stack of a thread, handed back when the thread ends.
+ */
+struct AlternateStack {
+
+    std::unique_ptr<char[]> memory_;            //!< @brief The stack; nullptr if none.
+
+    /**
+     * @brief   Destructor.
+     */
+    ~AlternateStack() {
+        if (memory_ != nullptr) {
+            stack_t stack{};
+            stack.ss_flags = SS_DISABLE;
+            sigaltstack(&stack, nullptr);
+        }
+    }
+};
+
+
+/**
+ * @brief   The alternate signal stack of the current thread.
+ */
+static thread_local AlternateStack alternate_stack;
+
+
+/**
+ * @brief   Gets the monotonic clock in milliseconds (async-signal-safe).
+ * @return  The milliseconds of the monotonic clock.
+ */
+static std::int64_t GetMonotonicMilliseconds() {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<std::int64_t>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+
+/**
+ * @brief   Ends the process when writing out events takes longer than the budget.
+ */
+static void OnCrashTimeout(int) {
+    // the crash handler has been reset to default (SA_RESETHAND): die of the original signal
+    raise(crash_signal.load());
+}
+
+
+/**
+ * @brief   The crash handler.
+ * @param   signal_number       the signal caught.
+ */
+static void OnFatalSignal(int signal_number) {
+
+    // only the first crashing thread flushes
+    static std::atomic_flag crashed = ATOMIC_FLAG_INIT;
+    if (!crashed.test_and_set()) {
+
+        auto budget = crash_budget.load();
+        crash_signal.store(signal_number);
+        crash_deadline.store(GetMonotonicMilliseconds() + budget);
+
+        // a hang (e.g. a blocking write) must not keep the crashed process alive
+        struct sigaction action {};
+        action.sa_handler = OnCrashTimeout;
+        action.sa_flags = SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGALRM, &action, nullptr);
+        alarm(static_cast<unsigned int>(budget / 1000 + 1));
+
+        RunCrashFlushers();
+        alarm(0);
+    }
+
+    // the handler has been reset to default (SA_RESETHAND): die as we would have
+    raise(signal_number);
+}
+
+
+bool headcode::logger::RegisterCrashFlusher(CrashFlusher flusher, void * context) {
+
+    if ((flusher == nullptr) || (context == nullptr)) {
+        return false;
+    }
+
+    for (auto & entry : crash_flushers) {
+        void * expected = nullptr;
+        if (entry.context_.compare_exchange_strong(expected, context)) {
+            entry.flusher_.store(flusher, std::memory_order_release);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void headcode::logger::SetupCrashStack() {
+
+    // room to run the handler on even if the stack of this thread overflowed
+    if (!crash_handler_installed.load() || (alternate_stack.memory_ != nullptr)) {
+        return;
+    }
+    alternate_stack.memory_.reset(new (std::nothrow) char[kAlternateStackSize]);
+    if (alternate_stack.memory_ == nullptr) {
+        return;
+    }
+    stack_t stack{};
+    stack.ss_sp = alternate_stack.memory_.get();
+    stack.ss_size = kAlternateStackSize;
+    stack.ss_flags = 0;
+    sigaltstack(&stack, nullptr);
+}
+
+
+void headcode::logger::UnregisterCrashFlusher(void * context) {
+
+    if (context == nullptr) {
+        return;
+    }
+
+    for (auto & entry : crash_flushers) {
+        if (entry.context_.load(std::memory_order_acquire) == context) {
+            entry.flusher_.store(nullptr, std::memory_order_release);
+            entry.context_.store(nullptr, std::memory_order_release);
+        }
+    }
+}
+
+
+int headcode::logger::GetCrashTimeLeft() {
+    auto deadline = crash_deadline.load();
+    auto left = (deadline == 0) ? crash_budget.load() : deadline - GetMonotonicMilliseconds();
+    return static_cast<int>(std::clamp<std::int64_t>(left, 0, crash_budget.load()));
+}
+
+
+void headcode::logger::RunCrashFlushers() {
+    for (auto & entry : crash_flushers) {
+        auto flusher = entry.flusher_.load(std::memory_order_acquire);
+        auto context = entry.context_.load(std::memory_order_acquire);
+        if ((flusher != nullptr) && (context != nullptr)) {
+            flusher(context);
+        }
+    }
+}
+
+
+void headcode::logger::InstallCrashHandler(std::chrono::milliseconds budget) {
+
+    crash_budget.store(std::max<std::int64_t>(budget.count(), 0));
+
+    crash_handler_installed.store(true);
+    SetupCrashStack();
+
+    struct sigaction action {};
+    action.sa_handler = OnFatalSignal;
+    action.sa_flags = SA_RESETHAND | SA_ONSTACK | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    for (auto signal_number : kFatalSignals) {
+        sigaction(signal_number, &action, nullptr);
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_CRASH_REGISTRY_HPP
+#define HEADCODE_SPACE_LOGGER_CRASH_REGISTRY_HPP
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A function called by the crash handler (see crash.hpp).
+ * It has to be async-signal-safe.
+ */
+using CrashFlusher = void (*)(void * context);
+
+
+/**
+ * @brief   Registers a function to be called when the process crashes.
+ * This is lock-free. There is room for a limited number of flushers only.
+ * @param   flusher     the function to call.
+ * @param   context     the argument to pass to the function.
+ * @return  true, if the flusher has been registered.
+ */
+bool RegisterCrashFlusher(CrashFlusher flusher, void * context);
+
+
+/**
+ * @brief   Removes a function registered with RegisterCrashFlusher().
+ * @param   context     the context the function has been registered with.
+ */
+void UnregisterCrashFlusher(void * context);
+
+
+/**
+ * @brief   Gets the time left for crash flushers to write out events.
+ * This is async-signal-safe.
+ * @return  The milliseconds left of the budget (see InstallCrashHandler()).
+ */
+int GetCrashTimeLeft();
+
+
+/**
+ * @brief   Calls all registered crash flushers.
+ * This is async-signal-safe.
+ */
+void RunCrashFlushers();
+
+
+/**
+ * @brief   Gives the current thread an alternate signal stack for the crash handler.
+ * Does nothing before InstallCrashHandler() or if the thread has one already. Logging
+ * threads get theirs with their first event, so a stack overflow there is caught as well.
+ */
+void SetupCrashStack();
+
+
+}
+
+
+#endif
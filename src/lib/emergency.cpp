@@ -0,0 +1,139 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/emergency.hpp>
+#include <headcode/logger/level.hpp>
+
+#include "signal_safe.hpp"
+
+#include <time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   Maximum number of emergency descriptors.
+ */
+static constexpr std::size_t kMaxEmergencyDescriptors = 8;
+
+
+/**
+ * @brief   The file descriptors Emergency messages are written to; -1 for an empty slot.
+ */
+static std::array<std::atomic<int>, kMaxEmergencyDescriptors> emergency_descriptors{2, -1, -1, -1, -1, -1, -1, -1};
+
+
+Emergency::~Emergency() noexcept {
+
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    signal_safe::LineBuffer prefix;
+    prefix.Append("[", 1);
+    prefix.AppendTime(static_cast<std::int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000);
+    prefix.Append("] ", 2);
+    prefix.AppendLevel(static_cast<int>(Level::kCritical));
+    if ((logger_name_ != nullptr) && (logger_name_[0] != '\0')) {
+        prefix.Append(" {", 2);
+        prefix.Append(logger_name_);
+        prefix.Append("}", 1);
+    }
+    prefix.Append(": ", 2);
+
+    // one line per line of the message, like the StandardFormatter; each line goes out with a single write
+    std::size_t start = 0;
+    do {
+        auto end = start;
+        while ((end < size_) && (message_[end] != '\n')) {
+            ++end;
+        }
+
+        signal_safe::LineBuffer line;
+        line.Append(prefix.GetData(), prefix.GetSize());
+        line.Append(message_ + start, end - start);
+        line.Append("\n", 1);
+        for (auto & descriptor : emergency_descriptors) {
+            auto fd = descriptor.load(std::memory_order_acquire);
+            if (fd >= 0) {
+                signal_safe::LineBuffer::Write(fd, line.GetData(), line.GetSize());
+            }
+        }
+
+        start = end + 1;
+    } while (start < size_);
+}
+
+
+Emergency & Emergency::operator<<(std::string_view text) noexcept {
+    auto size = std::min(text.size(), kCapacity - size_);
+    std::memcpy(message_ + size_, text.data(), size);
+    size_ += size;
+    return *this;
+}
+
+
+Emergency & Emergency::operator<<(void const * pointer) noexcept {
+    char digits[2 + 2 * sizeof(std::uintptr_t)];
+    auto value = reinterpret_cast<std::uintptr_t>(pointer);
+    std::size_t count = 0;
+    do {
+        digits[sizeof(digits) - 1 - count++] = "0123456789abcdef"[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+    digits[sizeof(digits) - 1 - count++] = 'x';
+    digits[sizeof(digits) - 1 - count++] = '0';
+    return *this << std::string_view{digits + sizeof(digits) - count, count};
+}
+
+
+Emergency & Emergency::AppendNumber(unsigned long long value, bool negative) noexcept {
+    char digits[21];
+    std::size_t count = 0;
+    do {
+        digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative) {
+        digits[sizeof(digits) - 1 - count++] = '-';
+    }
+    return *this << std::string_view{digits + sizeof(digits) - count, count};
+}
+
+
+bool headcode::logger::AddEmergencyDescriptor(int fd) noexcept {
+
+    if (fd < 0) {
+        return false;
+    }
+    for (auto & descriptor : emergency_descriptors) {
+        if (descriptor.load(std::memory_order_acquire) == fd) {
+            return true;
+        }
+    }
+    for (auto & descriptor : emergency_descriptors) {
+        int expected = -1;
+        if (descriptor.compare_exchange_strong(expected, fd, std::memory_order_acq_rel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void headcode::logger::RemoveEmergencyDescriptor(int fd) noexcept {
+    for (auto & descriptor : emergency_descriptors) {
+        int expected = fd;
+        descriptor.compare_exchange_strong(expected, -1, std::memory_order_acq_rel);
+    }
+}
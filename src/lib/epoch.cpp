@@ -0,0 +1,140 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "epoch.hpp"
+
+#include "crash_registry.hpp"
+
+#include <thread>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   The epoch announcement of a thread.
+ */
+struct EpochGuard::Slot {
+    std::atomic<std::uint64_t> epoch_{0};       //!< @brief The epoch the thread reads in; 0 if not reading.
+    std::atomic<bool> used_{true};              //!< @brief The slot belongs to a thread.
+    Slot * next_{nullptr};                      //!< @brief The next slot.
+    unsigned int depth_{0};                     //!< @brief Number of nested guards (touched by the owner only).
+};
+
+
+/**
+ * @brief   The current epoch; starts at 1 as 0 marks a thread not reading.
+ */
+static std::atomic<std::uint64_t> current_epoch{1};
+
+
+/**
+ * @brief   All slots ever created; slots of finished threads are reused, never freed.
+ */
+static std::atomic<EpochGuard::Slot *> slots{nullptr};
+
+
+/**
+ * @brief   The slot of the current thread.
+ */
+static thread_local EpochGuard::Slot * thread_slot{nullptr};
+
+
+/**
+ * @brief   Hands the slot of a thread back when the thread ends.
+ */
+struct SlotRelease {
+
+    /**
+     * @brief   Destructor.
+     */
+    ~SlotRelease() {
+        if (thread_slot != nullptr) {
+            thread_slot->epoch_.store(0, std::memory_order_release);
+            thread_slot->used_.store(false, std::memory_order_release);
+            thread_slot = nullptr;
+        }
+    }
+};
+
+
+/**
+ * @brief   Gets the slot of the current thread, taking a free one or creating one first.
+ * @return  The slot of the current thread.
+ */
+static EpochGuard::Slot * GetSlot() {
+
+    if (thread_slot != nullptr) {
+        return thread_slot;
+    }
+
+    static thread_local SlotRelease release;
+    (void) release;
+    SetupCrashStack();
+
+    for (auto slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next_) {
+        bool expected = false;
+        if (slot->used_.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            thread_slot = slot;
+            return slot;
+        }
+    }
+
+    auto slot = new EpochGuard::Slot;
+    slot->next_ = slots.load(std::memory_order_relaxed);
+    while (!slots.compare_exchange_weak(slot->next_, slot, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    thread_slot = slot;
+    return slot;
+}
+
+
+EpochGuard::EpochGuard() : slot_{GetSlot()} {
+
+    // announce before reading: a writer either sees the announcement or we see its replacement
+    if (slot_->depth_++ == 0) {
+        slot_->epoch_.store(current_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+
+EpochGuard::~EpochGuard() noexcept {
+    if (--slot_->depth_ == 0) {
+        slot_->epoch_.store(0, std::memory_order_release);
+    }
+}
+
+
+bool headcode::logger::IsEpochSafe(std::uint64_t retired) noexcept {
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (auto slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next_) {
+        auto epoch = slot->epoch_.load(std::memory_order_acquire);
+        if ((epoch != 0) && (epoch < retired)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+std::uint64_t headcode::logger::RetireEpoch() noexcept {
+    return current_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+}
+
+
+bool headcode::logger::WaitEpochSafe(std::uint64_t retired) noexcept {
+
+    if ((thread_slot != nullptr) && (thread_slot->depth_ > 0)) {
+        return IsEpochSafe(retired);
+    }
+    while (!IsEpochSafe(retired)) {
+        std::this_thread::yield();
+    }
+    return true;
+}
@@ -0,0 +1,102 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_EPOCH_HPP
+#define HEADCODE_SPACE_LOGGER_EPOCH_HPP
+
+#include <atomic>
+#include <cstdint>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Epoch based reclamation of data read by logging threads without locks.
+ *
+ * Logging threads read shared data (like the sink list of a logger) within an EpochGuard.
+ * A writer publishes a replacement, then calls RetireEpoch() for the data replaced and keeps
+ * it until IsEpochSafe() says no thread may still read it. Readers never wait and touch no
+ * shared cache line: each thread announces its epoch in a slot of its own.
+ */
+class EpochGuard {
+
+public:
+    struct Slot;
+
+private:
+    Slot * slot_;               //!< @brief The slot of this thread.
+
+public:
+    /**
+     * @brief   Constructor: the thread reads from now on.
+     * Guards may be nested; only the outermost one is announced. The first guard of a
+     * thread may need a new slot and throws std::bad_alloc if it cannot get one.
+     */
+    EpochGuard();
+
+    /**
+     * @brief   Copy constructor.
+     */
+    EpochGuard(EpochGuard const &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    EpochGuard(EpochGuard &&) = delete;
+
+    /**
+     * @brief   Destructor: the thread does not read anymore.
+     */
+    ~EpochGuard() noexcept;
+
+    /**
+     * @brief   Assignment operator.
+     */
+    EpochGuard & operator=(EpochGuard const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    EpochGuard & operator=(EpochGuard &&) = delete;
+};
+
+
+/**
+ * @brief   Starts a new epoch for data just replaced.
+ * Call this after the replacement has been published.
+ * @return  The epoch to pass to IsEpochSafe().
+ */
+std::uint64_t RetireEpoch() noexcept;
+
+
+/**
+ * @brief   Checks if data retired may be freed.
+ * @param   retired     the epoch returned by RetireEpoch().
+ * @return  true, if no thread reads since before the data had been retired.
+ */
+bool IsEpochSafe(std::uint64_t retired) noexcept;
+
+
+/**
+ * @brief   Waits until data retired may be freed.
+ * Guards span a single event only, so this returns soon. A thread inside an EpochGuard itself
+ * would wait for itself: then this does not wait at all.
+ * @param   retired     the epoch returned by RetireEpoch().
+ * @return  true, if the data may be freed now (see IsEpochSafe()).
+ */
+bool WaitEpochSafe(std::uint64_t retired) noexcept;
+
+
+}
+
+
+#endif
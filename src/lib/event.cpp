@@ -7,11 +7,52 @@
  */
 
 #include <headcode/logger/event.hpp>
+#include <headcode/logger/formatter.hpp>
 #include <headcode/logger/logger_core.hpp>
 
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+
 using namespace headcode::logger;
 
 
+/**
+ * @brief   Gets the operating system id of the current thread.
+ * @return  The id of the current thread.
+ */
+static std::uint64_t GetCurrentThreadId() {
+    thread_local std::uint64_t const thread_id = static_cast<std::uint64_t>(syscall(SYS_gettid));
+    return thread_id;
+}
+
+
+/**
+ * @brief   Reads the put area of a string buffer: the text written so far.
+ * The members are protected: pointers to them are taken by a derived class.
+ */
+struct PutArea : std::stringbuf {
+
+    /**
+     * @brief   Gets the text written so far.
+     * @param   buffer      the string buffer.
+     * @return  The text written to the buffer.
+     */
+    static std::string_view Get(std::stringbuf const * buffer) {
+        auto begin = (buffer->*&PutArea::pbase)();
+        auto end = (buffer->*&PutArea::pptr)();
+        return std::string_view{begin, static_cast<std::size_t>(end - begin)};
+    }
+};
+
+
+/**
+ * @brief   Sequence number handed out last (see Event::GetSequence()).
+ */
+static std::atomic<std::uint64_t> last_sequence{0};
+
+
 Event::Event(int level, std::string logger_name) : Event{level, Logger::GetLogger(std::move(logger_name))} {
 }
 
@@ -29,7 +70,8 @@ Event::Event(int level, Logger * logger)
         : time_point_{std::chrono::system_clock::now()},
           logger_{logger},
           level_{level},
-          since_start_{std::chrono::duration_cast<std::chrono::microseconds>(time_point_ - Logger::GetBirth())} {
+          since_start_{std::chrono::duration_cast<std::chrono::microseconds>(time_point_ - Logger::GetBirth())},
+          thread_id_{GetCurrentThreadId()} {
 
     // insist on root logger minimum
     if (logger_ == nullptr) {
@@ -38,7 +80,88 @@ Event::Event(int level, Logger * logger)
 }
 
 
+Event::Event(std::chrono::system_clock::time_point time_point,
+             int level,
+             Logger * logger,
+             std::uint64_t thread_id,
+             std::string const & message)
+        : Event{level, logger} {
+    time_point_ = time_point;
+    since_start_ = std::chrono::duration_cast<std::chrono::microseconds>(time_point_ - Logger::GetBirth());
+    thread_id_ = thread_id;
+    log_on_destruction_ = false;
+    write(message.data(), static_cast<std::streamsize>(message.size()));
+}
+
+
+void Event::SetTrace(TracePhase phase,
+                     std::chrono::system_clock::time_point time_point,
+                     std::chrono::microseconds duration) {
+    trace_phase_ = phase;
+    trace_duration_ = duration;
+    time_point_ = time_point;
+    since_start_ = std::chrono::duration_cast<std::chrono::microseconds>(time_point_ - Logger::GetBirth());
+}
+
+
+std::string const & Event::AddRendering(Formatter const & formatter, std::string const & key, std::string text) const {
+    // the first renderings are kept within the event: no allocation but for the texts
+    auto message_size = rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+    Rendering rendering{formatter.GetGeneration(), key, message_size, std::move(text)};
+    if (renderings_used_ < renderings_.size()) {
+        renderings_[renderings_used_] = std::move(rendering);
+        return renderings_[renderings_used_++].text_;
+    }
+    more_renderings_.push_back(std::move(rendering));
+    return more_renderings_.back().text_;
+}
+
+
+std::string const * Event::FindRendering(Formatter const & formatter, std::string const & key) const {
+
+    if (renderings_used_ == 0) {
+        return nullptr;
+    }
+
+    // formatters are told apart by their generation: the address of a formatter is reused
+    auto message_size = rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::out);
+    auto generation = formatter.GetGeneration();
+    auto matches = [&](Rendering const & rendering) {
+        return (rendering.message_size_ == message_size) &&
+               ((rendering.generation_ == generation) || (!key.empty() && (rendering.key_ == key)));
+    };
+    for (std::size_t i = 0; i < renderings_used_; ++i) {
+        if (matches(renderings_[i])) {
+            return &renderings_[i].text_;
+        }
+    }
+    for (auto const & rendering : more_renderings_) {
+        if (matches(rendering)) {
+            return &rendering.text_;
+        }
+    }
+
+    return nullptr;
+}
+
+
+std::string_view Event::GetMessageView() const {
+    return PutArea::Get(rdbuf());
+}
+
+
+std::uint64_t Event::GetSequence() const {
+    if (sequence_ == 0) {
+        sequence_ = last_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return sequence_;
+}
+
+
 Event::~Event() noexcept {
+    if (!log_on_destruction_) {
+        return;
+    }
     try {
         logger_->Log(*this);
     } catch (...) {
@@ -11,15 +11,60 @@
 #include <headcode/logger/event.hpp>
 #include <headcode/logger/logger_core.hpp>
 
+#include <atomic>
 #include <ctime>
 
 using namespace headcode::logger;
 
 
+/**
+ * @brief   Generation of the formatter created last (see Formatter::GetGeneration()).
+ */
+static std::atomic<std::uint64_t> last_generation{0};
+
+
+/**
+ * @brief   Hands out a new formatter generation.
+ * @return  A generation never handed out before.
+ */
+static std::uint64_t NextGeneration() noexcept {
+    return last_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+
+Formatter::Formatter() : generation_{NextGeneration()} {
+}
+
+
+Formatter::Formatter(Formatter const &) : generation_{NextGeneration()} {
+}
+
+
+Formatter::Formatter(Formatter &&) noexcept : generation_{NextGeneration()} {
+}
+
+
+Formatter & Formatter::operator=(Formatter const &) {
+    generation_ = NextGeneration();
+    return *this;
+}
+
+
+Formatter & Formatter::operator=(Formatter &&) noexcept {
+    generation_ = NextGeneration();
+    return *this;
+}
+
+
 std::string Formatter::CreateLevelString(Event const & event) {
+    return CreateLevelString(event.GetLevel());
+}
+
+
+std::string Formatter::CreateLevelString(int level_value) {
 
     // users may issue any number beyond debug --> cap those to "debug".
-    auto level = static_cast<Level>(std::min<int>(event.GetLevel(), static_cast<int>(Level::kDebug)));
+    auto level = static_cast<Level>(std::min<int>(level_value, static_cast<int>(Level::kDebug)));
 
     std::string res;
     res.resize(32);
@@ -44,12 +89,25 @@ std::string Formatter::CreateLoggerString(Event const & event) {
 }
 
 
+std::string Formatter::CreateLoggerString(std::string const & name) {
+    if (name.empty() || (name == "<root>")) {
+        return std::string{};
+    }
+    return std::string{"{"} + name + "}";
+}
+
+
 std::string Formatter::CreateTimeString(Event const & event) {
+    return CreateTimeString(event.GetTimePoint());
+}
+
+
+std::string Formatter::CreateTimeString(std::chrono::system_clock::time_point time_point) {
 
     std::string res;
 
-    std::time_t tt = std::chrono::system_clock::to_time_t(event.GetTimePoint());
-    auto duration_since_epoch = event.GetTimePoint().time_since_epoch();
+    std::time_t tt = std::chrono::system_clock::to_time_t(time_point);
+    auto duration_since_epoch = time_point.time_since_epoch();
     auto ms_since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(duration_since_epoch);
     auto ms_fraction = static_cast<int>(ms_since_epoch.count() - tt * 1000);
     struct tm tm {};
@@ -75,6 +133,24 @@ std::string Formatter::CreateTimeString(Event const & event) {
 }
 
 
+std::string const & Formatter::Format(Event const & event) {
+
+    auto const & key = GetRenderKey();
+    auto rendering = event.FindRendering(*this, key);
+    if (rendering != nullptr) {
+        return *rendering;
+    }
+
+    return event.AddRendering(*this, key, Format_(event));
+}
+
+
+std::string const & Formatter::GetRenderKey() const {
+    static std::string const key;
+    return key;
+}
+
+
 std::list<std::string> Formatter::SplitMessageIntoLines(std::string const & message) {
 
     std::list<std::string> res;
@@ -0,0 +1,150 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include "../binary_format.hpp"
+
+#include <algorithm>
+
+using namespace headcode::logger;
+using namespace headcode::logger::binary;
+
+
+std::string BinaryFormatter::Format_(Event const & event) {
+
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(event.GetTimePoint().time_since_epoch());
+    auto logger = event.GetLogger();
+
+    std::string res;
+    std::string head;
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+
+    if (!header_written_) {
+        head.append(kMagic, 4);
+        PutVarint(head, templates_ ? kVersion : kVersionPlain);
+        PutVarint(head, static_cast<std::uint64_t>(time.count()));
+        PutRecord(res, RecordType::kHeader, head);
+        header_written_ = true;
+        last_time_ = time.count();
+        block_.base_ = last_time_;
+    }
+
+    if (known_loggers_.size() <= logger->GetId()) {
+        known_loggers_.resize(logger->GetId() + 1, nullptr);
+    }
+    if (known_loggers_[logger->GetId()] != logger) {
+        auto name = logger->IsRootLogger() ? std::string{} : logger->GetName();
+        head.clear();
+        PutVarint(head, logger->GetId());
+        PutRecord(res, RecordType::kLogger, head, name);
+        known_loggers_[logger->GetId()] = logger;
+        block_.loggers_.push_back(std::move(name));
+    }
+
+    head.clear();
+    PutVarint(head, ZigZagEncode(event.GetLevel()));
+    PutVarint(head, logger->GetId());
+    PutVarint(head, event.GetThreadId());
+    PutVarint(head, ZigZagEncode(time.count() - last_time_));
+    auto message = event.str();
+    if (!templates_ || !WriteTemplateEvent(res, head, message)) {
+        PutRecord(res, RecordType::kEvent, head, message);
+    }
+    last_time_ = time.count();
+
+    // events do not come in order (threads, replays): the block covers the earliest to the latest
+    if (block_.events_ == 0) {
+        block_.first_ = last_time_;
+        block_.last_ = last_time_;
+        block_.min_level_ = event.GetLevel();
+        block_.max_level_ = event.GetLevel();
+    }
+    block_.first_ = std::min(block_.first_, last_time_);
+    block_.last_ = std::max(block_.last_, last_time_);
+    block_.min_level_ = std::min(block_.min_level_, event.GetLevel());
+    block_.max_level_ = std::max(block_.max_level_, event.GetLevel());
+    block_.events_++;
+    block_.size_ += res.size();
+
+    if ((index_block_size_ > 0) && (block_.size_ >= index_block_size_)) {
+        WriteIndex(res);
+    }
+
+    return res;
+}
+
+
+void BinaryFormatter::WriteIndex(std::string & out) {
+
+    std::string payload;
+    PutVarint(payload, static_cast<std::uint64_t>(block_.base_));
+    PutVarint(payload, static_cast<std::uint64_t>(block_.first_));
+    PutVarint(payload, static_cast<std::uint64_t>(block_.last_));
+    PutVarint(payload, static_cast<std::uint64_t>(last_time_));
+    PutVarint(payload, ZigZagEncode(block_.min_level_));
+    PutVarint(payload, ZigZagEncode(block_.max_level_));
+    PutVarint(payload, block_.events_);
+    PutVarint(payload, block_.size_);
+    PutVarint(payload, block_.loggers_.size());
+    for (auto const & name : block_.loggers_) {
+        PutVarint(payload, name.size());
+        payload.append(name);
+    }
+
+    auto payload_size = payload.size() + kIndexTrailerSize;
+    auto record_size = GetVarintSize(static_cast<std::uint64_t>(RecordType::kIndex)) + GetVarintSize(payload_size) +
+                       payload_size;
+    for (unsigned int i = 0; i < 4; ++i) {
+        payload.push_back(static_cast<char>((record_size >> (i * 8)) & 0xff));
+    }
+    payload.append(kIndexMagic, 4);
+
+    PutRecord(out, RecordType::kIndex, payload);
+
+    // next block: the block carries its own logger dictionary
+    block_ = Block{};
+    block_.base_ = last_time_;
+    std::fill(known_loggers_.begin(), known_loggers_.end(), nullptr);
+    known_templates_.clear();
+}
+
+
+bool BinaryFormatter::WriteTemplateEvent(std::string & out, std::string & head, std::string const & message) {
+
+    if (message.size() > kMaxTemplateSize) {
+        return false;
+    }
+
+    std::string tmpl;
+    std::string parameters;
+    if (!SplitTemplate(message, tmpl, parameters)) {
+        return false;
+    }
+
+    auto iter = known_templates_.find(tmpl);
+    if (iter == known_templates_.end()) {
+        if (known_templates_.size() >= kMaxTemplates) {
+            return false;
+        }
+        auto id = known_templates_.size();
+        std::string template_head;
+        PutVarint(template_head, id);
+        PutRecord(out, RecordType::kTemplate, template_head, tmpl);
+        iter = known_templates_.emplace(std::move(tmpl), id).first;
+    }
+
+    PutVarint(head, iter->second);
+    PutRecord(out, RecordType::kTemplateEvent, head, parameters);
+
+    return true;
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include "../json.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace headcode::logger;
+
+
+ChromeFormatter::ChromeFormatter() : pid_{std::to_string(getpid())} {
+}
+
+
+std::string const & ChromeFormatter::GetRenderKey() const {
+    static std::string const key{"chrome"};
+    return key;
+}
+
+
+std::string ChromeFormatter::Format_(Event const & event) {
+
+    auto const & message = event.GetMessage();
+    auto microseconds =
+            std::chrono::duration_cast<std::chrono::microseconds>(event.GetTimePoint().time_since_epoch()).count();
+    auto phase = event.GetTracePhase();
+
+    std::string json;
+    json.reserve(message.size() + 160);
+    json.append(R"({"name":)");
+    AppendJSONString(json, message);
+    json.append(R"(,"cat":)");
+    AppendJSONString(json, event.GetLogger()->GetName());
+    json.append(R"(,"ph":")");
+    if (phase == TracePhase::kNone) {
+        json.append(R"(i","s":"t)");
+    } else {
+        json.push_back(static_cast<char>(phase));
+    }
+    json.append(R"(","ts":)");
+    json.append(std::to_string(microseconds));
+    if (phase == TracePhase::kComplete) {
+        json.append(R"(,"dur":)");
+        json.append(std::to_string(event.GetTraceDuration().count()));
+    }
+    json.append(R"(,"pid":)");
+    json.append(pid_);
+    json.append(R"(,"tid":)");
+    json.append(std::to_string(event.GetThreadId()));
+    if (phase == TracePhase::kNone) {
+        auto level = std::clamp<int>(
+                event.GetLevel(), static_cast<int>(Level::kUndefined), static_cast<int>(Level::kDebug));
+        json.append(R"(,"args":{"level":)");
+        AppendJSONString(json, GetLevelText(static_cast<Level>(level)));
+        json.push_back('}');
+    }
+    json.append("},\n");
+
+    return json;
+}
@@ -12,8 +12,8 @@
 #include <headcode/logger/level.hpp>
 #include <headcode/logger/logger_core.hpp>
 
-#include <tuple>
-#include <vector>
+#include <algorithm>
+#include <array>
 
 using namespace headcode::logger;
 
@@ -49,110 +49,126 @@ static std::string const kColorDebug{"\x1B[38;5;244m"};
 
 
 /**
- * @brief   Gets the pre and post default terminal color strings for the levels.
+ * @brief   Turns a log level into an index of the prefix arrays.
+ * Levels below kUndefined are treated as kUndefined, levels above kDebug as kDebug.
  * @param   level           the log level.
- * @return  The pre and post default terminal color string.
+ * @return  The index of the level (0 for kUndefined up to 5 for kDebug).
  */
-static std::tuple<std::string, std::string> GetDefaultColors(int level) {
+static std::size_t GetLevelIndex(int level) {
+    return static_cast<std::size_t>(
+            std::clamp(level, static_cast<int>(Level::kUndefined), static_cast<int>(Level::kDebug)) + 1);
+}
+
+
+/**
+ * @brief   Gets the default terminal color for a level.
+ * @param   level           the log level.
+ * @return  The terminal color string.
+ */
+static std::string const & GetDefaultColor(int level) {
 
     switch (level) {
         case static_cast<int>(Level::kCritical):
-            return std::tuple<std::string, std::string>{kColorCritical, kColorReset};
+            return kColorCritical;
 
         case static_cast<int>(Level::kWarning):
-            return std::tuple<std::string, std::string>{kColorWarning, kColorReset};
+            return kColorWarning;
 
         case static_cast<int>(Level::kInfo):
-            return std::tuple<std::string, std::string>{kColorInfo, kColorReset};
+            return kColorInfo;
 
         default:
-            return std::tuple<std::string, std::string>{kColorDebug, kColorReset};
+            return kColorDebug;
     }
 }
 
 
 /**
- * @brief   Gets the pre and post terminal color strings for the time of this event.
- * @param   event       the event.
- * @return  The pre and post terminal color string.
+ * @brief   Gets the terminal color for the logger of an event.
+ * @param   id              the id of the logger.
+ * @param   level           the log level.
+ * @return  The terminal color string.
  */
-static std::tuple<std::string, std::string> GetTimeStringColors(Event const & event) {
-    return GetDefaultColors(event.GetLevel());
-}
+static std::string GetLoggerColor(unsigned int id, int level) {
 
+    switch (level) {
+        case static_cast<int>(Level::kCritical):
+            return kColorCritical;
 
-/**
- * @brief   Gets the pre and post terminal color strings for the level of this event.
- * @param   event       the event.
- * @return  The pre and post terminal color string.
- */
-static std::tuple<std::string, std::string> GetLevelStringColors(Event const & event) {
-    return GetDefaultColors(event.GetLevel());
+        case static_cast<int>(Level::kWarning):
+            return kColorWarning;
+
+        default:
+            break;
+    }
+
+    // The colors in the near neighbourhood are very much the same with a small epsilon.
+    // Therefore, based on the continuous index number of loggers, we make jumps with
+    // a prime number (hopefully acting as an algebraic generator), to get distinct colours
+    // for loggers with consecutive IDs. We pick from the 216 colors of the 16-231 range.
+
+    auto color = 16 + (static_cast<std::uint64_t>(id) * 11) % (232 - 16);
+    return std::string{"\x1B[38;5;"} + std::to_string(color) + "m";
 }
 
 
 /**
- * @brief   Gets the pre and post terminal color strings for the logger of this event.
- * @param   event       the event.
- * @return  The pre and post terminal color string.
+ * @brief   The colored start of each line (which precedes the time string) per level.
  */
-static std::tuple<std::string, std::string> GetLoggerStringColors(Event const & event) {
+static std::array<std::string, 6> const kLineStarts = {GetDefaultColor(static_cast<int>(Level::kUndefined)),
+                                                       GetDefaultColor(static_cast<int>(Level::kSilent)),
+                                                       GetDefaultColor(static_cast<int>(Level::kCritical)),
+                                                       GetDefaultColor(static_cast<int>(Level::kWarning)),
+                                                       GetDefaultColor(static_cast<int>(Level::kInfo)),
+                                                       GetDefaultColor(static_cast<int>(Level::kDebug))};
 
-    static std::vector<std::string> color_loggers;
-    if (color_loggers.empty()) {
-        color_loggers.resize(232 - 16);
-        for (int i = 16; i < 232; ++i) {
-            color_loggers[i - 16] = std::string{"\x1B[38;5;"} + std::to_string(i) + "m";
-        }
-    }
 
-    // The colors in the near neighbourhood are very much the same with a small epsilon.
-    // Therefore, based on the continuous index number of loggers, we make jumps with
-    // a prime number (hopefully acting as an algebraic generator), to get distinct colours
-    // for loggers with consecutive IDs.
+std::array<std::string, 6> ColorDarkBackgroundFormatter::CreatePrefixes(unsigned int id, std::string const & name) {
 
-    size_t index = (event.GetLogger()->GetId() * 11) % color_loggers.size();
-    switch (event.GetLevel()) {
-        case static_cast<int>(Level::kCritical):
-            return std::tuple<std::string, std::string>{kColorCritical, kColorReset};
+    std::array<std::string, 6> res;
 
-        case static_cast<int>(Level::kWarning):
-            return std::tuple<std::string, std::string>{kColorWarning, kColorReset};
+    for (std::size_t i = 0; i < res.size(); ++i) {
 
-        default:
-            return std::tuple<std::string, std::string>{color_loggers[index], kColorReset};
+        auto level = static_cast<int>(i) - 1;
+        auto const & color = GetDefaultColor(level);
+
+        std::string level_string;
+        level_string.resize(32);
+        snprintf(level_string.data(), 32, "(%-8s)", GetLevelText(static_cast<Level>(level)).data());
+        level_string.resize(level_string.find_last_of(')') + 1);
+
+        auto & prefix = res[i];
+        prefix.append(kColorReset).append(" ").append(color).append(level_string).append(kColorReset);
+        if (!name.empty()) {
+            prefix.append(" ").append(GetLoggerColor(id, level)).append("{").append(name).append("}");
+            prefix.append(kColorReset);
+        }
+        prefix.append(color).append(": ");
     }
+
+    return res;
 }
 
 
-/**
- * @brief   Gets the pre and post terminal color strings for a line of this event.
- * @param   event       the event.
- * @return  The pre and post terminal color string.
- */
-static std::tuple<std::string, std::string> GetLineStringColors(Event const & event) {
-    return GetDefaultColors(event.GetLevel());
+std::string const & ColorDarkBackgroundFormatter::GetRenderKey() const {
+    static std::string const key{"color-dark-background"};
+    return key;
 }
 
 
 std::string ColorDarkBackgroundFormatter::Format_(Event const & event) {
 
+    auto index = GetLevelIndex(event.GetLevel());
+    auto const & line_start = kLineStarts[index];
+    auto const & prefix = event.GetLogger()->GetColorPrefixes()[index];
+
     auto lines = SplitMessageIntoLines(event.str());
     auto time_string = CreateTimeString(event);
-    auto level_string = CreateLevelString(event);
-    auto logger_string = CreateLoggerString(event);
-
-    auto [time_pre, time_post] = GetTimeStringColors(event);
-    auto [level_pre, level_post] = GetLevelStringColors(event);
-    auto [logger_pre, logger_post] = GetLoggerStringColors(event);
-    auto [line_pre, line_post] = GetLineStringColors(event);
 
-    std::stringstream ss;
+    std::string res;
     for (auto const & line : lines) {
-        ss << time_pre << time_string << time_post << " " << level_pre << level_string << level_post
-           << (logger_string.empty() ? "" : " ") << logger_pre << logger_string << logger_post << line_pre << ": "
-           << line << line_post;
+        res.append(line_start).append(time_string).append(prefix).append(line).append(kColorReset);
     }
 
-    return ss.str();
+    return res;
 }
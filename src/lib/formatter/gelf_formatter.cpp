@@ -0,0 +1,69 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include "../json.hpp"
+#include "../severity.hpp"
+
+#include <unistd.h>
+
+using namespace headcode::logger;
+
+
+GELFFormatter::GELFFormatter() {
+    char host[256] = {0};
+    if (gethostname(host, sizeof(host) - 1) != 0) {
+        host[0] = '\0';
+    }
+    AppendJSONString(host_, host);
+}
+
+
+std::string const & GELFFormatter::GetRenderKey() const {
+    static std::string const key{"gelf"};
+    return key;
+}
+
+
+std::string GELFFormatter::Format_(Event const & event) {
+
+    auto message = event.GetMessage();
+    auto microseconds =
+            std::chrono::duration_cast<std::chrono::microseconds>(event.GetTimePoint().time_since_epoch()).count();
+
+    std::string json;
+    json.reserve(message.size() + host_.size() + 128);
+    json.append(R"({"version":"1.1","host":)");
+    json.append(host_);
+    json.append(R"(,"short_message":)");
+    auto newline = message.find('\n');
+    if ((newline == std::string::npos) || (newline + 1 == message.size())) {
+        AppendJSONString(json, std::string_view{message}.substr(0, newline));
+    } else {
+        AppendJSONString(json, std::string_view{message}.substr(0, newline));
+        json.append(R"(,"full_message":)");
+        AppendJSONString(json, message);
+    }
+    json.append(R"(,"timestamp":)");
+    AppendJSONSeconds(json, microseconds);
+    json.append(R"(,"level":)");
+    json.append(std::to_string(GetSyslogSeverity(event.GetLevel())));
+    json.append(R"(,"_logger":)");
+    AppendJSONString(json, event.GetLogger()->GetName());
+    json.append(R"(,"_thread_id":)");
+    json.append(std::to_string(event.GetThreadId()));
+    json.append(R"(,"_sequence":)");
+    json.append(std::to_string(event.GetSequence()));
+    json.push_back('}');
+
+    return json;
+}
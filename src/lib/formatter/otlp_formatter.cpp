@@ -0,0 +1,56 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include "../json.hpp"
+#include "../severity.hpp"
+
+#include <algorithm>
+
+using namespace headcode::logger;
+
+
+std::string const & OTLPFormatter::GetRenderKey() const {
+    static std::string const key{"otlp"};
+    return key;
+}
+
+
+std::string OTLPFormatter::Format_(Event const & event) {
+
+    auto const & message = event.GetMessage();
+    auto nanoseconds =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(event.GetTimePoint().time_since_epoch()).count();
+    auto level =
+            std::clamp<int>(event.GetLevel(), static_cast<int>(Level::kUndefined), static_cast<int>(Level::kDebug));
+
+    // 64 bit integers are strings in OTLP JSON
+    std::string json;
+    json.reserve(message.size() + 192);
+    json.append(R"({"timeUnixNano":")");
+    json.append(std::to_string(nanoseconds));
+    json.append(R"(","severityNumber":)");
+    json.append(std::to_string(GetOTelSeverity(event.GetLevel())));
+    json.append(R"(,"severityText":)");
+    AppendJSONString(json, GetLevelText(static_cast<Level>(level)));
+    json.append(R"(,"body":{"stringValue":)");
+    AppendJSONString(json, message);
+    json.append(R"(},"attributes":[{"key":"logger","value":{"stringValue":)");
+    AppendJSONString(json, event.GetLogger()->GetName());
+    json.append(R"(}},{"key":"thread.id","value":{"intValue":")");
+    json.append(std::to_string(event.GetThreadId()));
+    json.append(R"("}},{"key":"sequence","value":{"intValue":")");
+    json.append(std::to_string(event.GetSequence()));
+    json.append(R"("}}]})");
+
+    return json;
+}
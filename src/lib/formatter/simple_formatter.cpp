@@ -13,6 +13,12 @@
 using namespace headcode::logger;
 
 
+std::string const & SimpleFormatter::GetRenderKey() const {
+    static std::string const key{"simple"};
+    return key;
+}
+
+
 std::string SimpleFormatter::Format_(Event const & event) {
     return event.GetMessage();
 }
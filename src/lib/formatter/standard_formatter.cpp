@@ -9,21 +9,42 @@
 #include <headcode/logger/formatter.hpp>
 
 #include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
 
 using namespace headcode::logger;
 
 
+std::string const & StandardFormatter::GetRenderKey() const {
+    static std::string const key{"standard"};
+    return key;
+}
+
+
 std::string StandardFormatter::Format_(Event const & event) {
+    auto logger = event.GetLogger();
+    auto logger_name = ((logger == nullptr) || logger->IsRootLogger()) ? std::string{} : logger->GetName();
+    return Render(event.GetTimePoint(), event.GetLevel(), logger_name, event.str());
+}
+
+
+std::string StandardFormatter::Render(std::chrono::system_clock::time_point time_point,
+                                      int level,
+                                      std::string const & logger_name,
+                                      std::string const & message) {
 
-    auto lines = SplitMessageIntoLines(event.str());
-    auto time_string = CreateTimeString(event);
-    auto level_string = CreateLevelString(event);
-    auto logger_string = CreateLoggerString(event);
+    auto lines = SplitMessageIntoLines(message);
+    auto time_string = CreateTimeString(time_point);
+    auto level_string = CreateLevelString(level);
+    auto logger_string = CreateLoggerString(logger_name);
 
-    std::stringstream ss;
+    std::string res;
     for (auto const & line : lines) {
-        ss << time_string << " " << level_string << (logger_string.empty() ? "" : " ") << logger_string << ": " << line;
+        res.append(time_string).append(" ").append(level_string);
+        if (!logger_string.empty()) {
+            res.append(" ").append(logger_string);
+        }
+        res.append(": ").append(line);
     }
 
-    return ss.str();
+    return res;
 }
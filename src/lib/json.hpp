@@ -0,0 +1,86 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_JSON_HPP
+#define HEADCODE_SPACE_LOGGER_JSON_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Appends a text as JSON string (with quotes).
+ * Bytes beyond ASCII are taken as they are (UTF-8 is assumed).
+ * @param   json        the JSON text to append to.
+ * @param   text        the text to append.
+ */
+inline void AppendJSONString(std::string & json, std::string_view text) {
+
+    static char const hex[] = "0123456789abcdef";
+
+    json.push_back('"');
+    for (auto c : text) {
+        switch (c) {
+            case '"':
+                json.append("\\\"");
+                break;
+            case '\\':
+                json.append("\\\\");
+                break;
+            case '\n':
+                json.append("\\n");
+                break;
+            case '\r':
+                json.append("\\r");
+                break;
+            case '\t':
+                json.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    json.append("\\u00");
+                    json.push_back(hex[(c >> 4) & 0x0f]);
+                    json.push_back(hex[c & 0x0f]);
+                } else {
+                    json.push_back(c);
+                }
+        }
+    }
+    json.push_back('"');
+}
+
+
+/**
+ * @brief   Appends microseconds as seconds with 6 decimals, e.g. "1617871234.000123".
+ * @param   json            the JSON text to append to.
+ * @param   microseconds    the microseconds to append.
+ */
+inline void AppendJSONSeconds(std::string & json, std::int64_t microseconds) {
+    if (microseconds < 0) {
+        json.push_back('-');
+        microseconds = -microseconds;
+    }
+    auto fraction = std::to_string(microseconds % 1000000);
+    json.append(std::to_string(microseconds / 1000000));
+    json.push_back('.');
+    json.append(6 - fraction.size(), '0');
+    json.append(fraction);
+}
+
+
+}
+
+
+#endif
@@ -8,9 +8,16 @@
 
 #include <headcode/logger/logger_core.hpp>
 
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/formatter.hpp>
 #include <headcode/logger/sink.hpp>
 #include <headcode/logger/sink_factory.hpp>
 
+#include "epoch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <map>
 #include <shared_mutex>
 #include <utility>
@@ -108,6 +115,65 @@ struct LoggerRegistry {
 LoggerRegistry LoggerRegistry::registry_;
 
 
+/**
+ * @brief   An event stopped by a barrier and held back for a backtrace.
+ */
+struct BacktraceEntry {
+    std::chrono::system_clock::time_point time_point_;        //!< @brief When the event happened.
+    int level_{0};                                            //!< @brief Log level value.
+    Logger * logger_{nullptr};                                //!< @brief The logger the event is assigned.
+    Logger * barrier_logger_{nullptr};                        //!< @brief The logger which stopped the event.
+    std::uint64_t thread_id_{0};                              //!< @brief The id of the thread.
+    std::string message_;                                     //!< @brief The unformatted message.
+};
+
+
+/**
+ * @brief   The events a single thread held back for a backtrace.
+ */
+struct Backtrace {
+    std::vector<BacktraceEntry> entries_;        //!< @brief The ring of events.
+    std::size_t next_{0};                        //!< @brief Index of the next entry to write.
+    std::size_t size_{0};                        //!< @brief Number of entries held.
+    std::uint64_t generation_{0};                //!< @brief The loggers generation the entries refer to.
+};
+
+
+/**
+ * @brief   Number of stopped events held back per thread.
+ */
+static std::atomic<std::size_t> backtrace_depth{0};
+
+
+/**
+ * @brief   Bumped whenever logger instances vanish: held back events refering to them are dropped.
+ */
+static std::atomic<std::uint64_t> backtrace_generation{0};
+
+
+/**
+ * @brief   The backtrace of the current thread.
+ */
+static thread_local Backtrace backtrace;
+
+
+/**
+ * @brief   Gets the backtrace of the current thread, dropping stale entries.
+ * @param   depth       the backtrace depth in effect.
+ * @return  The backtrace of the current thread.
+ */
+static Backtrace & GetBacktrace(std::size_t depth) {
+    auto generation = backtrace_generation.load(std::memory_order_relaxed);
+    if ((backtrace.entries_.size() != depth) || (backtrace.generation_ != generation)) {
+        backtrace.entries_.resize(depth);
+        backtrace.next_ = 0;
+        backtrace.size_ = 0;
+        backtrace.generation_ = generation;
+    }
+    return backtrace;
+}
+
+
 }
 
 
@@ -177,12 +243,15 @@ void LoggerRegistryPurge() {
     auto lock = LoggerRegistry::registry_.LockWrite();
     LoggerRegistry::registry_.loggers_.clear();
     LoggerRegistry::registry_.logger_count = 0;
+    ++backtrace_generation;
 }
 #endif
 
 
 Logger::Logger(std::string name, unsigned int id) : name_{std::move(name)}, id_(id) {
     ancestors_ = CreateListOfAncestors(name_);
+    color_prefixes_ = ColorDarkBackgroundFormatter::CreatePrefixes(id_, name_);
+    PublishSinks(SinkList{});
 }
 
 
@@ -192,15 +261,36 @@ void Logger::AddSink(std::shared_ptr<Sink> sink) {
         return;
     }
 
-    bool present = false;
-    for (auto iter = sinks_.begin(); iter != sinks_.end() && !present; ++iter) {
-        present = (*iter).lock().get() == sink.get();
-    }
-    if (present) {
+    std::lock_guard<std::mutex> lock{sinks_mutex_};
+    if (std::find(sink_list_->begin(), sink_list_->end(), sink) != sink_list_->end()) {
         return;
     }
 
-    sinks_.push_back(sink);
+    auto sinks = *sink_list_;
+    sinks.push_back(std::move(sink));
+    PublishSinks(std::move(sinks));
+}
+
+
+bool Logger::Flush(std::chrono::steady_clock::time_point deadline) {
+
+    EpochGuard guard;
+    auto const & sinks = *sinks_.load(std::memory_order_acquire);
+    if (sinks.empty()) {
+        auto parent = GetParentLogger();
+        return (parent == nullptr) || parent->Flush(deadline);
+    }
+
+    bool done = true;
+    for (auto const & sink : sinks) {
+        done = sink->Flush(deadline) && done;
+    }
+    return done;
+}
+
+
+std::size_t Logger::GetBacktraceDepth() {
+    return backtrace_depth.load(std::memory_order_relaxed);
 }
 
 
@@ -222,11 +312,9 @@ Logger * Logger::GetLogger(std::string name) {
         LoggerRegistry::registry_.loggers_.clear();
 
         auto logger = std::unique_ptr<Logger>(new Logger{std::string{}, LoggerRegistry::registry_.logger_count++});
-        if (name.empty()) {
-            logger->SetSink(SinkFactory::Create("stderr:"));
-            logger->SetBarrier(Level::kWarning);
-            LoggerRegistry::registry_.loggers_.emplace(name, std::move(logger));
-        }
+        logger->SetSink(SinkFactory::Create("stderr:"));
+        logger->SetBarrier(Level::kWarning);
+        LoggerRegistry::registry_.loggers_.emplace(std::string{}, std::move(logger));
     }
 
     auto iter = LoggerRegistry::registry_.loggers_.find(name);
@@ -279,39 +367,126 @@ Logger * Logger::GetParentLogger() const {
 }
 
 
+std::vector<std::shared_ptr<Sink>> Logger::GetSinks() const {
+    EpochGuard guard;
+    return *sinks_.load(std::memory_order_acquire);
+}
+
+
 void Logger::Log(Event const & event) {
 
-    ++events_logged_;
+    events_logged_.fetch_add(1, std::memory_order_relaxed);
 
-    if (GetBarrier() > 0) {
-        Push(event);
-    } else {
+    auto barrier = GetBarrier();
+    if (barrier < 0) {
         auto parent = GetParentLogger();
         if (parent) {
             parent->Log(event);
         }
+        return;
+    }
+
+    auto level = event.GetLevel();
+    if ((level > 0) && (level <= barrier)) {
+        if (level <= static_cast<int>(Level::kWarning)) {
+            PushBacktrace();
+        }
+        Push(event);
+        return;
+    }
+
+    auto depth = GetBacktraceDepth();
+    if ((depth > 0) && (level > 0)) {
+        auto & trace = GetBacktrace(depth);
+        auto & entry = trace.entries_[trace.next_];
+        entry.time_point_ = event.GetTimePoint();
+        entry.level_ = level;
+        entry.logger_ = const_cast<Logger *>(event.GetLogger());
+        entry.barrier_logger_ = this;
+        entry.thread_id_ = event.GetThreadId();
+        entry.message_ = event.str();
+        trace.next_ = (trace.next_ + 1) % depth;
+        trace.size_ = std::min(trace.size_ + 1, depth);
     }
 }
 
 
+void Logger::PublishSinks(SinkList sinks) {
+
+    // a sink removed is released once the logging threads still using it are done with their event;
+    // only if we log right now ourselves (e.g. from within a sink) it lives on to a later change
+    auto retired = std::move(sink_list_);
+    sink_list_ = std::make_unique<SinkList const>(std::move(sinks));
+    sinks_.store(sink_list_.get(), std::memory_order_seq_cst);
+    if (retired != nullptr) {
+        auto epoch = RetireEpoch();
+        retired_sink_lists_.push_back(RetiredSinkList{epoch, std::move(retired)});
+        WaitEpochSafe(epoch);
+    }
+    retired_sink_lists_.remove_if([](auto const & list) { return IsEpochSafe(list.epoch_); });
+}
+
+
 void Logger::Push(Event const & event) {
 
-    if (sinks_.empty()) {
+    // the list is ours until the guard is gone: no reference counting per event and sink
+    EpochGuard guard;
+    auto const & sinks = *sinks_.load(std::memory_order_acquire);
+    if (sinks.empty()) {
         auto parent = GetParentLogger();
         if (parent) {
             parent->Push(event);
         }
     } else {
-        for (auto & sink : sinks_) {
-            auto real_sink = sink.lock();
-            if (real_sink.get() != nullptr) {
-                real_sink->Log(event);
-            }
+        for (auto const & sink : sinks) {
+            sink->Log(event);
         }
     }
 }
 
 
+void Logger::PushBacktrace() {
+
+    auto depth = GetBacktraceDepth();
+    if (depth == 0) {
+        return;
+    }
+
+    auto & trace = GetBacktrace(depth);
+    auto first = (trace.next_ + depth - trace.size_) % depth;
+    for (std::size_t i = 0; i < trace.size_; ++i) {
+        auto & entry = trace.entries_[(first + i) % depth];
+        Event replay{entry.time_point_,
+                     entry.level_,
+                     entry.logger_,
+                     entry.thread_id_,
+                     "[backtrace] " + entry.message_};
+        replay.SetBacktrace(true);
+        entry.barrier_logger_->Push(replay);
+    }
+    trace.next_ = 0;
+    trace.size_ = 0;
+}
+
+
+void Logger::RemoveSink(std::shared_ptr<Sink> const & sink) {
+
+    std::lock_guard<std::mutex> lock{sinks_mutex_};
+    if (std::find(sink_list_->begin(), sink_list_->end(), sink) == sink_list_->end()) {
+        return;
+    }
+
+    SinkList sinks;
+    std::remove_copy(sink_list_->begin(), sink_list_->end(), std::back_inserter(sinks), sink);
+    PublishSinks(std::move(sinks));
+}
+
+
+void Logger::SetBacktraceDepth(std::size_t depth) {
+    backtrace_depth.store(depth, std::memory_order_relaxed);
+}
+
+
 void Logger::SetBarrier(int barrier) {
 
     if (barrier < -1) {
@@ -323,7 +498,7 @@ void Logger::SetBarrier(int barrier) {
         return;
     }
 
-    barrier_ = barrier;
+    barrier_.store(barrier, std::memory_order_relaxed);
 }
 
 
@@ -333,8 +508,33 @@ void Logger::SetBarrier(Level barrier) {
 
 
 void Logger::SetSink(std::shared_ptr<Sink> sink) {
-    sinks_.clear();
+    SinkList sinks;
     if (sink != nullptr) {
-        sinks_.push_back(sink);
+        sinks.push_back(std::move(sink));
+    }
+    std::lock_guard<std::mutex> lock{sinks_mutex_};
+    PublishSinks(std::move(sinks));
+}
+
+
+bool headcode::logger::Shutdown(std::chrono::steady_clock::time_point deadline) {
+
+    // a sink may be attached to many loggers: flush each one once, without holding the registry
+    std::vector<std::shared_ptr<Sink>> sinks;
+    {
+        auto lock_read = LoggerRegistry::registry_.LockRead();
+        for (auto const & [_, logger] : LoggerRegistry::registry_.loggers_) {
+            for (auto & sink : logger->GetSinks()) {
+                if (std::find(sinks.begin(), sinks.end(), sink) == sinks.end()) {
+                    sinks.push_back(std::move(sink));
+                }
+            }
+        }
+    }
+
+    bool done = true;
+    for (auto const & sink : sinks) {
+        done = sink->Flush(deadline) && done;
     }
+    return done;
 }
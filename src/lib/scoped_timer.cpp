@@ -0,0 +1,40 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/scoped_timer.hpp>
+
+using namespace headcode::logger;
+
+
+ScopedTimer::ScopedTimer(std::string logger_name, std::string name, Level level, Mode mode)
+        : logger_name_{std::move(logger_name)},
+          name_{std::move(name)},
+          level_{level},
+          mode_{mode},
+          start_{std::chrono::system_clock::now()},
+          steady_start_{std::chrono::steady_clock::now()} {
+
+    if (mode_ == Mode::kBeginEnd) {
+        TraceEvent{logger_name_, name_, TracePhase::kBegin, start_, std::chrono::microseconds{0}, level_};
+    }
+}
+
+
+ScopedTimer::~ScopedTimer() noexcept {
+
+    // the wall clock may have been set meanwhile: the end is measured with the monotonic clock
+    auto elapsed = GetElapsed();
+    try {
+        if (mode_ == Mode::kBeginEnd) {
+            TraceEvent{logger_name_, name_, TracePhase::kEnd, start_ + elapsed, std::chrono::microseconds{0}, level_};
+        } else {
+            TraceEvent{logger_name_, name_, TracePhase::kComplete, start_, elapsed, level_};
+        }
+    } catch (...) {
+    }
+}
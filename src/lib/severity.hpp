@@ -0,0 +1,87 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SEVERITY_HPP
+#define HEADCODE_SPACE_LOGGER_SEVERITY_HPP
+
+#include <headcode/logger/level.hpp>
+
+#include <syslog.h>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Maps an event level to a syslog severity (as used by journald and GELF).
+ * Levels beyond Debug are Debug too, all other unknown levels are errors.
+ * @param   level       the event level.
+ * @return  The syslog severity.
+ */
+inline int GetSyslogSeverity(int level) {
+
+    switch (level) {
+
+        case static_cast<int>(Level::kCritical):
+            return LOG_CRIT;
+
+        case static_cast<int>(Level::kWarning):
+            return LOG_WARNING;
+
+        case static_cast<int>(Level::kInfo):
+            return LOG_INFO;
+
+        case static_cast<int>(Level::kDebug):
+            return LOG_DEBUG;
+
+        default:
+            break;
+    }
+
+    return (level > static_cast<int>(Level::kDebug)) ? LOG_DEBUG : LOG_ERR;
+}
+
+
+/**
+ * @brief   Maps an event level to an OpenTelemetry severity number.
+ * Critical is FATAL (21), Warning WARN (13), Info INFO (9), Debug DEBUG (5) and levels
+ * beyond Debug are TRACE (1). All other levels are unspecified (0).
+ * @param   level       the event level.
+ * @return  The OpenTelemetry severity number.
+ */
+inline int GetOTelSeverity(int level) {
+
+    switch (level) {
+
+        case static_cast<int>(Level::kCritical):
+            return 21;
+
+        case static_cast<int>(Level::kWarning):
+            return 13;
+
+        case static_cast<int>(Level::kInfo):
+            return 9;
+
+        case static_cast<int>(Level::kDebug):
+            return 5;
+
+        default:
+            break;
+    }
+
+    return (level > static_cast<int>(Level::kDebug)) ? 1 : 0;
+}
+
+
+}
+
+
+#endif
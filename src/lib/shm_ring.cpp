@@ -0,0 +1,175 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "shm_ring.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+using namespace headcode::logger;
+
+
+ShmRing::~ShmRing() {
+    if (memory_ != nullptr) {
+        munmap(memory_, size_);
+    }
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+
+std::unique_ptr<ShmRing> ShmRing::Create(std::string const & name, std::size_t size, std::size_t slot_size) {
+
+    slot_size = std::max<std::size_t>(slot_size, sizeof(RingSlot) + 16);
+    slot_size = (slot_size + alignof(RingSlot) - 1) / alignof(RingSlot) * alignof(RingSlot);
+    std::uint64_t slot_count = 2;
+    while (slot_count * 2 * slot_size <= size) {
+        slot_count *= 2;
+    }
+
+    auto fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        return (errno == EEXIST) ? Open(name) : nullptr;
+    }
+
+    auto total_size = sizeof(RingHeader) + slot_count * slot_size;
+    if (ftruncate(fd, static_cast<off_t>(total_size)) == -1) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    auto memory = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    // the object is zero filled: sequences of 0 never match a ticket
+    auto header = new (memory) RingHeader{};
+    std::memcpy(header->magic_, kRingMagic, sizeof(kRingMagic));
+    header->version_ = kRingVersion;
+    header->slot_size_ = static_cast<std::uint32_t>(slot_size);
+    header->slot_count_ = slot_count;
+    header->ready_.store(1, std::memory_order_release);
+    munmap(memory, total_size);
+
+    auto ring = std::unique_ptr<ShmRing>{new ShmRing};
+    if (!ring->Map(fd)) {
+        return nullptr;
+    }
+
+    return ring;
+}
+
+
+std::string ShmRing::GetObjectName(std::string path) {
+    path.erase(0, path.find_first_not_of('/'));
+    if (path.empty()) {
+        path = "hcs-logger";
+    }
+    std::replace(path.begin(), path.end(), '/', '.');
+    return "/" + path;
+}
+
+
+bool ShmRing::Map(int fd) {
+
+    fd_ = fd;
+
+    // a ring just created by someone else may not be ready yet
+    struct stat st {};
+    for (int i = 0; i < 100; ++i) {
+        if ((fstat(fd, &st) == 0) && (static_cast<std::size_t>(st.st_size) > sizeof(RingHeader))) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    if (static_cast<std::size_t>(st.st_size) <= sizeof(RingHeader)) {
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(st.st_size);
+    memory_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory_ == MAP_FAILED) {
+        memory_ = nullptr;
+        return false;
+    }
+
+    header_ = static_cast<RingHeader *>(memory_);
+    for (int i = 0; (i < 100) && (header_->ready_.load(std::memory_order_acquire) == 0); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    auto slot_count = header_->slot_count_;
+    if ((header_->ready_.load(std::memory_order_acquire) == 0) ||
+        (std::memcmp(header_->magic_, kRingMagic, sizeof(kRingMagic)) != 0) ||
+        (header_->version_ != kRingVersion) || (header_->slot_size_ <= sizeof(RingSlot)) ||
+        (header_->slot_size_ % alignof(RingSlot) != 0) || (slot_count < 2) ||
+        ((slot_count & (slot_count - 1)) != 0) || (sizeof(RingHeader) + slot_count * header_->slot_size_ > size_)) {
+        return false;
+    }
+
+    slots_ = static_cast<char *>(memory_) + sizeof(RingHeader);
+    mask_ = slot_count - 1;
+
+    return true;
+}
+
+
+std::unique_ptr<ShmRing> ShmRing::Open(std::string const & name) {
+
+    auto fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    auto ring = std::unique_ptr<ShmRing>{new ShmRing};
+    if (!ring->Map(fd)) {
+        return nullptr;
+    }
+
+    return ring;
+}
+
+
+void ShmRing::Write(std::string const & data) {
+
+    auto data_size = GetSlotDataSize();
+    auto size = std::min<std::size_t>(data.size(), (mask_ + 1) / 2 * data_size);
+    auto needed = std::max<std::uint64_t>((size + data_size - 1) / data_size, 1);
+
+    auto ticket = header_->head_.fetch_add(needed, std::memory_order_relaxed);
+
+    std::size_t written = 0;
+    for (std::uint64_t i = 0; i < needed; ++i) {
+
+        auto & slot = GetSlot(ticket + i);
+        slot.sequence_.store(2 * (ticket + i) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto chunk = std::min(size - written, data_size);
+        slot.size_ = static_cast<std::uint32_t>(chunk);
+        slot.flags_ = (i == 0 ? kRingSlotFirst : 0) | (i + 1 == needed ? kRingSlotLast : 0);
+        std::memcpy(GetSlotData(slot), data.data() + written, chunk);
+        written += chunk;
+
+        slot.sequence_.store(2 * (ticket + i) + 2, std::memory_order_release);
+    }
+}
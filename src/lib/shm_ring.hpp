@@ -0,0 +1,230 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SHM_RING_HPP
+#define HEADCODE_SPACE_LOGGER_SHM_RING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+
+/**
+ * @brief   The shared memory ring buffer.
+ *
+ * The ring lives in a POSIX shared memory object. It starts with a header followed by a
+ * power of 2 number of equally sized slots:
+ *
+ *      RingHeader      magic, version, geometry, head and tail position
+ *      RingSlot        sequence, size, flags, data bytes
+ *      ...
+ *
+ * Positions (tickets) grow forever; the slot of a ticket is ticket % slot count.
+ *
+ * Writers never wait: a record needing n slots claims n consecutive tickets by a single
+ * atomic add on the head. For each of its slots the writer sets the slot sequence to
+ * 2 * ticket + 1 (busy), copies the data and sets the sequence to 2 * ticket + 2 (done).
+ * Records larger than a single slot are spread over consecutive slots marked with the
+ * kFirst and kLast flags.
+ *
+ * A reader at ticket t expects the sequence 2 * t + 2. A smaller value means the slot is
+ * still being written, a larger value means writers have lapped the reader: the slot has
+ * been overwritten and the reader lost data. After copying a slot the reader checks the
+ * sequence again to detect slots overwritten while copying (like a seqlock). The reader
+ * stores its position in the tail of the header, so a restarted reader continues there.
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Header of the ring.
+ */
+struct RingHeader {
+    char magic_[8];                                   //!< @brief "HCSRING" + '\0'.
+    std::uint32_t version_;                           //!< @brief Version of the ring layout.
+    std::uint32_t slot_size_;                         //!< @brief Size of a slot in bytes (incl. RingSlot).
+    std::uint64_t slot_count_;                        //!< @brief Number of slots (power of 2).
+    std::atomic<std::uint32_t> ready_;                //!< @brief Set to 1 after initialization.
+    alignas(64) std::atomic<std::uint64_t> head_;     //!< @brief Next ticket to claim by writers.
+    alignas(64) std::atomic<std::uint64_t> tail_;     //!< @brief Next ticket to read by the reader.
+};
+
+
+/**
+ * @brief   Head of a single slot. The data bytes follow immediately.
+ */
+struct RingSlot {
+    std::atomic<std::uint64_t> sequence_;        //!< @brief 2 * ticket + 1 while busy, 2 * ticket + 2 when done.
+    std::uint32_t size_;                         //!< @brief Number of data bytes in this slot.
+    std::uint32_t flags_;                        //!< @brief kFirst and/or kLast.
+};
+
+
+/**
+ * @brief   Slot holds the first part of a record.
+ */
+static constexpr std::uint32_t kRingSlotFirst = 1;
+
+
+/**
+ * @brief   Slot holds the last part of a record.
+ */
+static constexpr std::uint32_t kRingSlotLast = 2;
+
+
+/**
+ * @brief   Magic bytes of the ring header.
+ */
+static constexpr char const kRingMagic[8] = "HCSRING";
+
+
+/**
+ * @brief   Version of the ring layout.
+ */
+static constexpr std::uint32_t kRingVersion = 1;
+
+
+/**
+ * @brief   Default size of the ring in bytes.
+ */
+static constexpr std::size_t kRingDefaultSize = 1024 * 1024;
+
+
+/**
+ * @brief   Default size of a slot in bytes.
+ */
+static constexpr std::size_t kRingDefaultSlotSize = 256;
+
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared memory ring needs lock free atomics");
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "shared memory ring needs lock free atomics");
+
+
+/**
+ * @brief   A ring mapped into this process.
+ */
+class ShmRing {
+
+    int fd_{-1};                         //!< @brief File descriptor of the shared memory object.
+    void * memory_{nullptr};             //!< @brief Start of the mapping.
+    std::size_t size_{0};                //!< @brief Size of the mapping.
+    RingHeader * header_{nullptr};       //!< @brief The ring header.
+    char * slots_{nullptr};              //!< @brief The first slot.
+    std::uint64_t mask_{0};              //!< @brief slot count - 1.
+
+    /**
+     * @brief   Constructor.
+     */
+    ShmRing() = default;
+
+public:
+    /**
+     * @brief   Copy constructor.
+     */
+    ShmRing(ShmRing const &) = delete;
+
+    /**
+     * @brief   Move constructor.
+     */
+    ShmRing(ShmRing &&) = delete;
+
+    /**
+     * @brief   Destructor. Unmaps the ring (the shared memory object stays).
+     */
+    ~ShmRing();
+
+    /**
+     * @brief   Assignment operator.
+     */
+    ShmRing & operator=(ShmRing const &) = delete;
+
+    /**
+     * @brief   Move operator.
+     */
+    ShmRing & operator=(ShmRing &&) = delete;
+
+    /**
+     * @brief   Creates (if missing) and maps a ring.
+     * An existing ring is used as it is, regardless of the size asked for.
+     * @param   name            name of the shared memory object (e.g. "/app").
+     * @param   size            size of the ring in bytes (for a new ring).
+     * @param   slot_size       size of a slot in bytes (for a new ring).
+     * @return  The mapped ring or nullptr on failure.
+     */
+    static std::unique_ptr<ShmRing> Create(std::string const & name, std::size_t size, std::size_t slot_size);
+
+    /**
+     * @brief   Maps an existing ring.
+     * @param   name            name of the shared memory object (e.g. "/app").
+     * @return  The mapped ring or nullptr if there is no (valid) ring.
+     */
+    static std::unique_ptr<ShmRing> Open(std::string const & name);
+
+    /**
+     * @brief   Gets the ring header.
+     * @return  The ring header.
+     */
+    [[nodiscard]] RingHeader & GetHeader() const {
+        return *header_;
+    }
+
+    /**
+     * @brief   Gets the number of data bytes per slot.
+     * @return  The number of data bytes per slot.
+     */
+    [[nodiscard]] std::size_t GetSlotDataSize() const {
+        return header_->slot_size_ - sizeof(RingSlot);
+    }
+
+    /**
+     * @brief   Gets the slot of a ticket.
+     * @param   ticket          the ticket.
+     * @return  The slot of the ticket.
+     */
+    [[nodiscard]] RingSlot & GetSlot(std::uint64_t ticket) const {
+        return *reinterpret_cast<RingSlot *>(slots_ + (ticket & mask_) * header_->slot_size_);
+    }
+
+    /**
+     * @brief   Gets the data bytes of a slot.
+     * @param   slot            the slot.
+     * @return  The data bytes of the slot.
+     */
+    [[nodiscard]] static char * GetSlotData(RingSlot & slot) {
+        return reinterpret_cast<char *>(&slot) + sizeof(RingSlot);
+    }
+
+    /**
+     * @brief   Turns the path of a "shm:" URL into a shared memory object name.
+     * @param   path            the path of the URL (e.g. "app" or "/app").
+     * @return  The name of the shared memory object (e.g. "/app").
+     */
+    static std::string GetObjectName(std::string path);
+
+    /**
+     * @brief   Writes a record into the ring. This never waits.
+     * Records larger than half of the ring are truncated.
+     * @param   data            the record.
+     */
+    void Write(std::string const & data);
+
+private:
+    /**
+     * @brief   Maps the shared memory object and checks the header.
+     * @param   fd              the file descriptor of the shared memory object.
+     * @return  true, if the ring is valid.
+     */
+    bool Map(int fd);
+};
+
+
+}
+
+
+#endif
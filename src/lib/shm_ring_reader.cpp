@@ -0,0 +1,111 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/shm_ring_reader.hpp>
+
+#include "shm_ring.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
+using namespace headcode::logger;
+
+
+ShmRingReader::ShmRingReader(std::string const & name) : ring_{ShmRing::Open(ShmRing::GetObjectName(name))} {
+    if (ring_) {
+        position_ = ring_->GetHeader().tail_.load(std::memory_order_acquire);
+    }
+}
+
+
+ShmRingReader::~ShmRingReader() = default;
+
+
+bool ShmRingReader::IsOpen() const {
+    return ring_ != nullptr;
+}
+
+
+bool ShmRingReader::Next(std::string & record) {
+
+    if (!ring_) {
+        return false;
+    }
+
+    auto & header = ring_->GetHeader();
+    auto slot_count = header.slot_count_;
+    std::string data;
+
+    while (true) {
+
+        auto head = header.head_.load(std::memory_order_acquire);
+        if (position_ >= head) {
+            return false;
+        }
+
+        // writers lapped us
+        if (head - position_ > slot_count) {
+            lost_ += head - slot_count - position_;
+            position_ = head - slot_count;
+            in_record_ = false;
+        }
+
+        auto & slot = ring_->GetSlot(position_);
+        auto expected = 2 * position_ + 2;
+        auto sequence = slot.sequence_.load(std::memory_order_acquire);
+        if (sequence < expected) {
+            // still being written: wait for it, unless the writer seems to have gone
+            if (head - position_ <= slot_count / 2) {
+                return false;
+            }
+            sequence = expected + 1;
+        }
+
+        if (sequence == expected) {
+            auto size = std::min<std::size_t>(slot.size_, ring_->GetSlotDataSize());
+            auto flags = slot.flags_;
+            data.assign(ShmRing::GetSlotData(slot), size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence_.load(std::memory_order_relaxed) != expected) {
+                sequence = expected + 1;
+            } else {
+                if ((flags & kRingSlotFirst) != 0) {
+                    partial_.clear();
+                    in_record_ = true;
+                }
+                if (in_record_) {
+                    partial_.append(data);
+                } else {
+                    // the start of this record has been lost already
+                    ++lost_;
+                }
+                if (((flags & kRingSlotLast) != 0) && in_record_) {
+                    in_record_ = false;
+                    record.swap(partial_);
+                    partial_.clear();
+                    ++position_;
+                    header.tail_.store(position_, std::memory_order_release);
+                    return true;
+                }
+            }
+        }
+
+        if (sequence != expected) {
+            // overwritten (before or while reading)
+            ++lost_;
+            in_record_ = false;
+        }
+        ++position_;
+    }
+}
+
+
+void ShmRingReader::Unlink(std::string const & name) {
+    shm_unlink(ShmRing::GetObjectName(name).c_str());
+}
@@ -0,0 +1,246 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SIGNAL_SAFE_HPP
+#define HEADCODE_SPACE_LOGGER_SIGNAL_SAFE_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "crash_registry.hpp"
+
+
+/**
+ * @brief   Helpers usable in signal handlers.
+ *
+ * Nothing in here allocates memory, takes locks or touches locale or time zone data,
+ * so all of it is async-signal-safe (as long as write(2) is).
+ */
+namespace headcode::logger::signal_safe {
+
+
+/**
+ * @brief   A line of text assembled on the stack.
+ * Text exceeding the capacity is cut off.
+ */
+class LineBuffer {
+
+    static constexpr std::size_t kCapacity = 1024;        //!< @brief Maximum size of a line.
+
+    char buffer_[kCapacity];        //!< @brief The text.
+    std::size_t size_{0};           //!< @brief The number of bytes used.
+
+public:
+    /**
+     * @brief   Appends bytes.
+     * @param   data        the bytes.
+     * @param   size        the number of bytes.
+     */
+    void Append(char const * data, std::size_t size) {
+        if (size > kCapacity - size_) {
+            size = kCapacity - size_;
+        }
+        std::memcpy(buffer_ + size_, data, size);
+        size_ += size;
+    }
+
+    /**
+     * @brief   Appends a zero terminated string.
+     * @param   text        the string.
+     */
+    void Append(char const * text) {
+        Append(text, std::strlen(text));
+    }
+
+    /**
+     * @brief   Appends an unsigned number.
+     * @param   value       the number.
+     * @param   width       minimum number of digits (padded with '0').
+     */
+    void AppendNumber(std::uint64_t value, unsigned int width = 1) {
+        char digits[20];
+        unsigned int count = 0;
+        do {
+            digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while ((value != 0) && (count < sizeof(digits)));
+        while ((count < width) && (count < sizeof(digits))) {
+            digits[sizeof(digits) - 1 - count++] = '0';
+        }
+        Append(digits + sizeof(digits) - count, count);
+    }
+
+    /**
+     * @brief   Appends a time as "YYYY-MM-DDThh:mm:ss,mmm+00:00" (UTC).
+     * @param   microseconds        microseconds since epoch.
+     */
+    void AppendTime(std::int64_t microseconds) {
+
+        auto seconds = microseconds / 1000000;
+        auto milliseconds = (microseconds % 1000000) / 1000;
+        if (milliseconds < 0) {
+            milliseconds += 1000;
+            --seconds;
+        }
+        auto days = seconds / 86400;
+        auto second_of_day = seconds % 86400;
+        if (second_of_day < 0) {
+            second_of_day += 86400;
+            --days;
+        }
+
+        // civil date from days since epoch (Howard Hinnant's algorithm)
+        days += 719468;
+        auto era = (days >= 0 ? days : days - 146096) / 146097;
+        auto day_of_era = days - era * 146097;
+        auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+        auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        auto mp = (5 * day_of_year + 2) / 153;
+        auto day = day_of_year - (153 * mp + 2) / 5 + 1;
+        auto month = mp < 10 ? mp + 3 : mp - 9;
+        auto year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+        AppendNumber(static_cast<std::uint64_t>(year), 4);
+        Append("-", 1);
+        AppendNumber(static_cast<std::uint64_t>(month), 2);
+        Append("-", 1);
+        AppendNumber(static_cast<std::uint64_t>(day), 2);
+        Append("T", 1);
+        AppendNumber(static_cast<std::uint64_t>(second_of_day / 3600), 2);
+        Append(":", 1);
+        AppendNumber(static_cast<std::uint64_t>(second_of_day / 60 % 60), 2);
+        Append(":", 1);
+        AppendNumber(static_cast<std::uint64_t>(second_of_day % 60), 2);
+        Append(",", 1);
+        AppendNumber(static_cast<std::uint64_t>(milliseconds), 3);
+        Append("+00:00", 6);
+    }
+
+    /**
+     * @brief   Appends a log level as the StandardFormatter does: "(level   )".
+     * @param   level       the log level value.
+     */
+    void AppendLevel(int level) {
+        static char const * const texts[] = {
+                "(undefined)", "(silent  )", "(critical)", "(warning )", "(info    )", "(debug   )"};
+        if (level < -1) {
+            level = -1;
+        }
+        if (level > 4) {
+            level = 4;
+        }
+        Append(texts[level + 1]);
+    }
+
+    /**
+     * @brief   Gets the text assembled so far.
+     * @return  The text (not zero terminated).
+     */
+    [[nodiscard]] char const * GetData() const {
+        return buffer_;
+    }
+
+    /**
+     * @brief   Gets the size of the text assembled so far.
+     * @return  The number of bytes.
+     */
+    [[nodiscard]] std::size_t GetSize() const {
+        return size_;
+    }
+
+    /**
+     * @brief   Writes the text to a file descriptor and clears the buffer.
+     * @param   fd          the file descriptor.
+     */
+    void Flush(int fd) {
+        Write(fd, buffer_, size_);
+        size_ = 0;
+    }
+
+    /**
+     * @brief   Writes all bytes to a file descriptor, retrying on interrupts and short writes.
+     * @param   fd          the file descriptor.
+     * @param   data        the bytes.
+     * @param   size        the number of bytes.
+     * @return  true, if all bytes have been written.
+     */
+    static bool Write(int fd, char const * data, std::size_t size) {
+        while (size > 0) {
+            auto written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+};
+
+
+/**
+ * @brief   Tries to take a spin lock, giving up after a while: the holder may be the crashed thread.
+ * @param   lock        the spin lock.
+ * @return  true, if the lock has been taken.
+ */
+inline bool TryLock(std::atomic_flag & lock) {
+    for (int i = 0; i < 10000; ++i) {
+        if (!lock.test_and_set(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @brief   Sends all bytes over a (possibly non-blocking) socket within the crash time budget.
+ * A datagram or seqpacket socket takes the bytes as a single message.
+ * @param   fd          the socket.
+ * @param   data        the bytes.
+ * @param   size        the number of bytes.
+ * @return  true, if all bytes have been sent.
+ */
+inline bool Send(int fd, char const * data, std::size_t size) {
+    do {
+        auto sent = ::send(fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                return false;
+            }
+            pollfd writable{fd, POLLOUT, 0};
+            auto timeout = GetCrashTimeLeft();
+            if ((timeout == 0) || (poll(&writable, 1, timeout) != 1)) {
+                return false;
+            }
+            continue;
+        }
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    } while (size > 0);
+    return true;
+}
+
+
+}
+
+
+#endif
@@ -13,19 +13,33 @@
 
 #include <headcode/url/url.hpp>
 
+#include "epoch.hpp"
+
 using namespace headcode::logger;
 using namespace headcode::url;
 
 
-Sink::Sink(std::string url) : url_{std::move(url)}, formatter_{std::make_unique<StandardFormatter>()} {
+Sink::Sink(std::string url) : url_{std::move(url)} {
+    SetFormatter(std::make_unique<StandardFormatter>());
 }
 
 
 Sink::~Sink() = default;
 
 
-std::string Sink::Format(Event const & event) {
-    return formatter_->Format(event);
+void Sink::Dump() {
+    Dump_();
+}
+
+
+bool Sink::Flush(std::chrono::steady_clock::time_point deadline) {
+    return Flush_(deadline);
+}
+
+
+std::string const & Sink::Format(Event const & event) {
+    EpochGuard guard;
+    return formatter_.load(std::memory_order_acquire)->Format(event);
 }
 
 
@@ -34,10 +48,16 @@ std::string Sink::GetDescription() const {
 }
 
 
+std::shared_ptr<Formatter const> Sink::GetFormatter() const {
+    std::lock_guard<std::mutex> lock{formatters_mutex_};
+    return current_formatter_;
+}
+
+
 void Sink::Log(Event const & event) {
     auto level = event.GetLevel();
     if ((level > 0) && (level <= GetBarrier())) {
-        events_logged_++;
+        events_logged_.fetch_add(1, std::memory_order_relaxed);
         Log_(event);
     }
 }
@@ -47,14 +67,23 @@ void Sink::SetBarrier(int barrier) {
     if (barrier < 0) {
         return;
     }
-    barrier_ = barrier;
+    barrier_.store(barrier, std::memory_order_relaxed);
 }
 
 
 void Sink::SetFormatter(std::unique_ptr<Formatter> && formatter) {
     if (formatter.get() != nullptr) {
-        formatter_.reset();
-        formatter_.swap(formatter);
+        // wait for events still formatted with the old one; unless we log ourselves right now
+        std::lock_guard<std::mutex> lock{formatters_mutex_};
+        auto retired = std::move(current_formatter_);
+        formatter_.store(formatter.get(), std::memory_order_seq_cst);
+        current_formatter_ = std::move(formatter);
+        if (retired != nullptr) {
+            auto epoch = RetireEpoch();
+            retired_formatters_.emplace_back(epoch, std::move(retired));
+            WaitEpochSafe(epoch);
+        }
+        retired_formatters_.remove_if([](auto const & retired) { return IsEpochSafe(retired.first); });
     }
 }
 
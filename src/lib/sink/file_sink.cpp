@@ -7,11 +7,22 @@
  */
 
 #include "file_sink.hpp"
+#include "../crash_registry.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+#include "../worker_thread.hpp"
 
+#include <headcode/logger/event.hpp>
 #include <headcode/logger/formatter.hpp>
 
 #include <headcode/url/url.hpp>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 
 using namespace headcode::logger;
@@ -30,6 +41,29 @@ std::map<std::string, std::shared_ptr<FileSink>> FileSink::Producer::sinks;
 std::mutex FileSink::Producer::mutex;
 
 
+/**
+ * @brief   Writes all of the data to a file.
+ * @param   fd          the file descriptor.
+ * @param   data        the data to write.
+ * @param   size        the number of bytes to write.
+ * @return  true, if all data has been written.
+ */
+static bool WriteAll(int fd, char const * data, std::size_t size) {
+    while (size > 0) {
+        auto written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+
 FileSink::FileSink(std::string file_url) : MutexSink{file_url} {
     URL url{file_url};
     if (url.IsValid() && (url.GetScheme() == "file")) {
@@ -37,10 +71,150 @@ FileSink::FileSink(std::string file_url) : MutexSink{file_url} {
         if (url.GetPath().empty()) {
             SetURL(std::string{"file:a.log"});
         }
+        auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+        auto format = parameters.find("format");
+        if ((format != parameters.end()) && (format->second == "binary")) {
+            SetFormatter(std::make_unique<BinaryFormatter>(BinaryFormatter::kDefaultIndexBlockSize,
+                                                           IsURLQueryFlagSet(parameters, "templates")));
+        }
+        if ((format != parameters.end()) && (format->second == "chrome")) {
+            SetFormatter(std::make_unique<ChromeFormatter>());
+            chrome_ = true;
+        }
+
+        SetCombining(IsURLQueryFlagSet(parameters, "combine"));
+
+        auto sync = parameters.find("sync");
+        if ((sync != parameters.end()) && (sync->second != "never")) {
+            sync_on_flush_ = true;
+            if ((sync->second != "flush") && (sync->second != "periodic")) {
+                ParseURLQueryLevel(sync->second, sync_level_);
+            }
+        }
+        auto periodic = (sync != parameters.end()) && (sync->second == "periodic");
+        sync_interval_ = std::chrono::milliseconds{
+                GetURLQuerySize(parameters, "sync_interval", periodic ? kDefaultSyncInterval : 0)};
+        sync_on_flush_ = sync_on_flush_ || (sync_interval_.count() > 0);
+
+        // syncing and buffering need the file kept open
+        capacity_ = GetURLQuerySize(parameters, "buffer", 0);
+        if ((capacity_ > 0) || (sync_level_ > 0) || (sync_interval_.count() > 0)) {
+            fd_ = open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        }
+        if ((fd_ >= 0) && (capacity_ > 0)) {
+            buffer_ = std::make_unique<char[]>(capacity_);
+            RegisterCrashFlusher(&FileSink::CrashFlush, this);
+        } else {
+            capacity_ = 0;
+        }
+        if ((fd_ >= 0) && (sync_interval_.count() > 0)) {
+            syncer_ = StartWorker("sync", [this]() { Sync(); });
+        }
+    }
+}
+
+
+FileSink::~FileSink() {
+
+    if (syncer_.joinable()) {
+        {
+            auto lock = std::unique_lock<std::mutex>{sync_mutex_};
+            sync_stop_ = true;
+        }
+        sync_wakeup_.notify_one();
+        syncer_.join();
+    }
+
+    if (fd_ >= 0) {
+        UnregisterCrashFlusher(this);
+        WriteBuffer();
+        if (sync_on_flush_) {
+            fdatasync(fd_);
+        }
+        close(fd_);
     }
 }
 
 
+void FileSink::Append(char const * data, std::size_t size) {
+
+    if (buffered_.load() + size > capacity_) {
+        WriteBuffer();
+    }
+    if (size > capacity_) {
+        WriteAll(fd_, data, size);
+        return;
+    }
+
+    while (crash_guard_.test_and_set(std::memory_order_acquire)) {
+    }
+    std::memcpy(buffer_.get() + buffered_.load(), data, size);
+    buffered_.store(buffered_.load() + size);
+    crash_guard_.clear(std::memory_order_release);
+}
+
+
+void FileSink::CrashFlush(void * context) {
+
+    auto sink = static_cast<FileSink *>(context);
+
+    // the crashing thread may be in the middle of adding an event: wait a bit, then go on anyway
+    signal_safe::TryLock(sink->crash_guard_);
+    WriteAll(sink->fd_, sink->buffer_.get(), sink->buffered_.load());
+    sink->buffered_.store(0);
+}
+
+
+void FileSink::Dump_() {
+    if (fd_ >= 0) {
+        auto lock = LockWrite();
+        WriteBuffer();
+    }
+}
+
+
+bool FileSink::WriteBuffer() {
+    while (crash_guard_.test_and_set(std::memory_order_acquire)) {
+    }
+    auto written = WriteAll(fd_, buffer_.get(), buffered_.load());
+    buffered_.store(0);
+    crash_guard_.clear(std::memory_order_release);
+    return written;
+}
+
+
+bool FileSink::Flush_(std::chrono::steady_clock::time_point deadline) {
+
+    if (filename_.empty()) {
+        return true;
+    }
+
+    // a sync once started cannot be cut short: do not start one past the deadline
+    auto lock = LockWrite();
+    if (fd_ >= 0) {
+        if (!WriteBuffer()) {
+            return false;
+        }
+        return !sync_on_flush_ || ((std::chrono::steady_clock::now() < deadline) && (fdatasync(fd_) == 0));
+    }
+    if (!sync_on_flush_) {
+        return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+    }
+
+    // each event has been written at once: sync what is in the file
+    auto fd = open(filename_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    auto synced = fdatasync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+
 std::string FileSink::GetDescription_() const {
     return std::string{"FileSink to "} + filename_;
 }
@@ -52,10 +226,58 @@ void FileSink::Log_(Event const & event) {
         return;
     }
 
-    auto lock = LockWrite();
+    if (fd_ >= 0) {
+        // formatters may keep state between records: format in the order of writing
+        auto lock = LockWrite();
+        auto const & record = Format(event);
+        struct stat status {};
+        if (chrome_ && (buffered_.load() == 0) && (fstat(fd_, &status) == 0) && (status.st_size == 0)) {
+            Append("[\n", 2);
+        }
+        Append(record.data(), record.size());
+        dirty_.store(true, std::memory_order_relaxed);
+
+        auto level = event.GetLevel();
+        if ((level == static_cast<int>(Level::kCritical)) || (level <= sync_level_)) {
+            WriteBuffer();
+        }
+        if (level <= sync_level_) {
+            fdatasync(fd_);
+        }
+        return;
+    }
+
+    Write(event);
+}
+
+
+void FileSink::Sync() {
+
+    auto lock = std::unique_lock<std::mutex>{sync_mutex_};
+    while (!sync_wakeup_.wait_for(lock, sync_interval_, [&]() { return sync_stop_; })) {
+
+        if (!dirty_.exchange(false, std::memory_order_relaxed)) {
+            continue;
+        }
+
+        // loggers only wait for the buffer to be written, not for the disk
+        {
+            auto write_lock = LockWrite();
+            WriteBuffer();
+        }
+        fdatasync(fd_);
+    }
+}
+
+
+void FileSink::Write_(std::string const & records) {
     std::ofstream stream;
-    stream.open(filename_, std::ios::out | std::ios::app);
-    stream << Format(event);
+    stream.open(filename_, std::ios::out | std::ios::app | std::ios::binary);
+    if (chrome_ && (stream.seekp(0, std::ios::end).tellp() == 0)) {
+        // the trace event array is left open: the viewers do not need the closing bracket
+        stream << "[\n";
+    }
+    stream << records;
     stream.flush();
 }
 
@@ -15,8 +15,14 @@
 
 #include <headcode/url/url.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 
 /**
@@ -31,6 +37,27 @@ namespace headcode::logger {
  * The file is not truncated. Log messages will be appended at the end.
  * If a filename is missing, then "a.log" will be created.
  *
+ * URL query parameters:
+ *      format=binary       use a BinaryFormatter
+ *      templates=true      with format=binary: write messages as templates and parameters
+ *      format=chrome       use a ChromeFormatter: a trace for chrome://tracing or Perfetto
+ *      combine=true        threads logging at once write their events together (see MutexSink)
+ *      buffer=BYTES        collect events in a buffer of this size, written when full, on
+ *                          Critical events, on Dump(), on Flush() and on a crash (see InstallCrashHandler())
+ *      sync=never          never sync the file to stable storage (the default)
+ *      sync=flush          sync the file to stable storage (fdatasync) on Flush()
+ *      sync=LEVEL          sync the file after each event of this level or above (e.g. "critical")
+ *      sync=periodic       sync the file every second (if written to)
+ *      sync_interval=MS    sync the file every MS milliseconds (if written to), e.g. with sync=critical
+ *
+ * Without a buffer each event is written at once. With a buffer the file is kept open and
+ * written in large chunks: events logged shortly before the process is killed (SIGKILL) or
+ * dies without the crash handler installed are lost.
+ *
+ * Events written are in the page cache, safe from the process dying but not from a power
+ * loss. The sync policies trade throughput for durability: each sync waits for the disk.
+ * Periodic syncing happens on a thread of the sink, which also writes out the buffer. All
+ * policies but "never" sync on Flush() and when the sink is destroyed.
  *
  * Example: log all to a file "app.log":
  *
@@ -122,7 +149,26 @@ class FileSink : public MutexSink {
         }
     };
 
-    std::string filename_;        //!< @brief The name of the file to write to.
+    std::string filename_;                              //!< @brief The name of the file to write to.
+    bool chrome_{false};                                //!< @brief Write a Chrome trace (a JSON array).
+    int fd_{-1};                                        //!< @brief The file kept open when buffering.
+    std::unique_ptr<char[]> buffer_;                    //!< @brief Events not written yet.
+    std::size_t capacity_{0};                           //!< @brief Size of the buffer; 0 if unbuffered.
+    std::atomic<std::size_t> buffered_{0};              //!< @brief Bytes in the buffer.
+    std::atomic_flag crash_guard_ = ATOMIC_FLAG_INIT;   //!< @brief Held while the buffer changes.
+    /**
+     * @brief   Default interval of sync=periodic in milliseconds.
+     */
+    static constexpr std::size_t kDefaultSyncInterval = 1000;
+
+    bool sync_on_flush_{false};                         //!< @brief fdatasync() on Flush().
+    int sync_level_{0};                                 //!< @brief fdatasync() after events up to this level.
+    std::chrono::milliseconds sync_interval_{0};        //!< @brief Interval of periodic syncs; 0 if none.
+    std::atomic<bool> dirty_{false};                    //!< @brief Events logged since the last periodic sync.
+    bool sync_stop_{false};                             //!< @brief The sync thread shall stop.
+    std::mutex sync_mutex_;                             //!< @brief Guards sync_stop_.
+    std::condition_variable sync_wakeup_;               //!< @brief Wakes the sync thread.
+    std::thread syncer_;                                //!< @brief Syncs periodically.
 
 public:
     /**
@@ -131,12 +177,62 @@ public:
      */
     explicit FileSink(std::string file_url);
 
+    /**
+     * @brief   Destructor.
+     */
+    ~FileSink() override;
+
     /**
      * @brief   Registers a Producer at the Sink Factory.
      */
     static void RegisterProducer();
 
 private:
+    /**
+     * @brief   Adds bytes to the buffer, writing the buffer first if they do not fit.
+     * The caller holds the write lock.
+     * @param   data            the bytes to add.
+     * @param   size            the number of bytes.
+     */
+    void Append(char const * data, std::size_t size);
+
+    /**
+     * @brief   Writes the buffer to the file on a crash.
+     * @param   context         the sink.
+     */
+    static void CrashFlush(void * context);
+
+    /**
+     * @brief   Writes out the buffer.
+     */
+    void Dump_() override;
+
+    /**
+     * @brief   Writes the buffer to the file and empties it. The caller holds the write lock.
+     * @return  true, if the buffer has been written.
+     */
+    bool WriteBuffer();
+
+    /**
+     * @brief   Writes out the buffer and syncs the file, if configured.
+     * Writing the buffer and fdatasync() cannot be bounded: the deadline only keeps a sync
+     * from being started late, a sync started may take longer.
+     * @param   deadline    the latest time to start syncing.
+     * @return  true, if all has been written (and synced, if configured).
+     */
+    bool Flush_(std::chrono::steady_clock::time_point deadline) override;
+
+    /**
+     * @brief   The loop of the thread syncing periodically.
+     */
+    void Sync();
+
+    /**
+     * @brief   Appends records to the file (unbuffered).
+     * @param   records     the records to write.
+     */
+    void Write_(std::string const & records) override;
+
     /**
      * @brief   Gets the sink description.
      * @return  A human readable description of this sink.
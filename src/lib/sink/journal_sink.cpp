@@ -0,0 +1,180 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "journal_sink.hpp"
+#include "../severity.hpp"
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All JournalSinks storage.
+ */
+std::map<std::string, std::shared_ptr<JournalSink>> JournalSink::Producer::sinks;
+
+
+/**
+ * @brief   All JournalSinks access synchronization mutex.
+ */
+std::mutex JournalSink::Producer::mutex;
+
+
+/**
+ * @brief   The socket journald listens on for native protocol messages.
+ */
+static char const * const kDefaultJournalSocket = "/run/systemd/journal/socket";
+
+
+/**
+ * @brief   Appends a field in the journal native protocol.
+ * Values containing a newline are stored with an explicit size.
+ * @param   payload     the datagram to append to.
+ * @param   name        the field name.
+ * @param   value       the field value.
+ */
+static void AppendField(std::string & payload, char const * name, std::string const & value) {
+
+    payload.append(name);
+    if (value.find('\n') == std::string::npos) {
+        payload.push_back('=');
+        payload.append(value);
+    } else {
+        payload.push_back('\n');
+        auto size = static_cast<std::uint64_t>(value.size());
+        for (int i = 0; i < 8; ++i) {
+            payload.push_back(static_cast<char>(size >> (8 * i)));
+        }
+        payload.append(value);
+    }
+    payload.push_back('\n');
+}
+
+
+/**
+ * @brief   Creates the address of a unix socket.
+ * @param   path        the path of the socket.
+ * @return  The socket address.
+ */
+static sockaddr_un GetAddress(std::string const & path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+
+JournalSink::JournalSink(std::string journal_url) : Sink{journal_url} {
+
+    URL url{journal_url};
+    if (!url.IsValid() || (url.GetScheme() != "journal")) {
+        return;
+    }
+
+    path_ = std::string{url.GetPath()};
+    if (path_.empty()) {
+        path_ = kDefaultJournalSocket;
+    }
+    socket_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+}
+
+
+JournalSink::~JournalSink() {
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
+
+std::string JournalSink::GetDescription_() const {
+    return std::string{"JournalSink to "} + path_;
+}
+
+
+void JournalSink::Log_(Event const & event) {
+
+    if (socket_ < 0) {
+        return;
+    }
+
+    std::string payload;
+    payload.reserve(256);
+    AppendField(payload, "PRIORITY", std::to_string(GetSyslogSeverity(event.GetLevel())));
+    AppendField(payload, "MESSAGE", event.str());
+    AppendField(payload, "SYSLOG_IDENTIFIER", program_invocation_short_name);
+    AppendField(payload, "TID", std::to_string(event.GetThreadId()));
+    AppendField(payload, "HCS_LOGGER", event.GetLogger()->GetName());
+
+    auto address = GetAddress(path_);
+    if (sendto(socket_, payload.data(), payload.size(), MSG_NOSIGNAL, reinterpret_cast<sockaddr *>(&address),
+               sizeof(address)) < 0) {
+        if ((errno == EMSGSIZE) || (errno == ENOBUFS)) {
+            SendMemfd(payload);
+        }
+    }
+}
+
+
+void JournalSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<JournalSink::Producer>());
+    }
+}
+
+
+void JournalSink::SendMemfd(std::string const & payload) {
+
+    auto fd = memfd_create("hcs-logger-journal", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return;
+    }
+
+    auto written = write(fd, payload.data(), payload.size());
+    if ((written != static_cast<ssize_t>(payload.size())) ||
+        (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)) {
+        close(fd);
+        return;
+    }
+
+    // journald takes the fields of a datagram without payload from the passed file descriptor
+    union {
+        cmsghdr header_;
+        char buffer_[CMSG_SPACE(sizeof(int))];
+    } control{};
+
+    auto address = GetAddress(path_);
+    msghdr message{};
+    message.msg_name = &address;
+    message.msg_namelen = sizeof(address);
+    message.msg_control = control.buffer_;
+    message.msg_controllen = sizeof(control.buffer_);
+
+    auto header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+    sendmsg(socket_, &message, MSG_NOSIGNAL);
+    close(fd);
+}
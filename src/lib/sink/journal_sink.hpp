@@ -0,0 +1,154 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_JOURNAL_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_JOURNAL_SINK_HPP
+
+#include <headcode/logger/sink.hpp>
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which speaks the systemd journal native protocol.
+ *
+ * Each event is sent as a datagram of fields to the journal socket. The formatter
+ * of the sink is not used: journald stores the fields and indexes them on its own.
+ *
+ *      PRIORITY            syslog priority of the event level
+ *      MESSAGE             the message of the event, unformatted
+ *      SYSLOG_IDENTIFIER   the short name of the program
+ *      TID                 the id of the thread creating the event
+ *      HCS_LOGGER          the name of the logger
+ *
+ * Datagrams too large for the socket are passed in a sealed memfd instead.
+ *
+ * URL: "journal:" for the default socket ("/run/systemd/journal/socket") or
+ * "journal:/path/to/socket" for any other.
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("journal:");
+ *      headcode::logger::Logger::GetLogger()->SetSink(sink);
+ * @endcode
+ */
+class JournalSink : public Sink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<JournalSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<JournalSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "JournalSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return parsed_url.GetScheme() == "journal";
+        }
+    };
+
+    std::string path_;              //!< @brief Path of the journal socket.
+    int socket_{-1};                //!< @brief The datagram socket to send from.
+
+public:
+    /**
+     * @brief   Constructs a sink which sends the log events to the journal.
+     * @param   journal_url     URL of the journal socket.
+     */
+    explicit JournalSink(std::string journal_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~JournalSink() override;
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   This does the actual logging.
+     * @param   event       the event to log.
+     */
+    void Log_(Event const & event) override;
+
+    /**
+     * @brief   Passes a payload too large for a datagram in a sealed memfd.
+     * @param   payload     the fields to send.
+     */
+    void SendMemfd(std::string const & payload);
+};
+
+
+}
+
+
+#endif
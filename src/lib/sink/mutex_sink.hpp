@@ -11,6 +11,8 @@
 
 #include <headcode/logger/sink.hpp>
 
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <shared_mutex>
 #include <string>
@@ -25,10 +27,27 @@ namespace headcode::logger {
 /**
  * @brief   A sink which safeguards concurrent logging actions.
  * This sink serializes parallel writes.
+ *
+ * Events passed to Write() are formatted and handed to Write_() under the write lock, so
+ * formatters keeping state between records (like the BinaryFormatter) see the events in the
+ * order they are written. In combining mode (see SetCombining()) threads do not queue up for
+ * the lock one by one: a thread formats its event, appends the record to a shared batch
+ * (both under the batch lock) and waits until the record has been written. Whoever finds no
+ * other thread writing takes the whole batch and writes it with a single Write_(), then
+ * leaves - a waiting thread whose record has not been written yet takes the next batch.
+ * Many small writes become a few large ones, each thread waits for its own record only.
  */
 class MutexSink : public Sink {
 
-    std::mutex mutex_;        //!< @brief mutex to write to file.
+    std::mutex mutex_;                                  //!< @brief mutex to write to file.
+    bool combining_{false};                             //!< @brief Combine the records of threads.
+    std::mutex combine_mutex_;                          //!< @brief Guards the members below.
+    std::condition_variable written_;                   //!< @brief Signals a batch written.
+    std::string batch_;                                 //!< @brief Records waiting to be written.
+    std::string spare_;                                 //!< @brief Buffer for the next batch.
+    std::uint64_t enqueued_{0};                         //!< @brief Number of records added to batches.
+    std::uint64_t written_count_{0};                    //!< @brief Number of records written.
+    bool writing_{false};                               //!< @brief A thread is writing a batch.
 
 protected:
     /**
@@ -45,6 +64,67 @@ protected:
     [[nodiscard]] std::unique_lock<std::mutex> LockWrite() {
         return std::unique_lock<std::mutex>{mutex_};
     }
+
+    /**
+     * @brief   Turns combining of the records of concurrent threads on or off (see description).
+     * Call this before logging.
+     * @param   combining       combine the records of threads.
+     */
+    void SetCombining(bool combining) {
+        combining_ = combining;
+    }
+
+    /**
+     * @brief   Formats an event, writes the record with Write_() and returns when it has been written.
+     * @param   event       the event to write.
+     */
+    void Write(Event const & event) {
+
+        if (!combining_) {
+            auto lock = LockWrite();
+            Write_(Format(event));
+            return;
+        }
+
+        auto lock = std::unique_lock<std::mutex>{combine_mutex_};
+        batch_.append(Format(event));
+        auto ticket = ++enqueued_;
+        while (written_count_ < ticket) {
+
+            if (writing_) {
+                written_.wait(lock);
+                continue;
+            }
+
+            // take the batch, write it without blocking others from adding to the next one
+            writing_ = true;
+            std::string batch;
+            batch.swap(spare_);
+            batch.swap(batch_);
+            auto last = enqueued_;
+            lock.unlock();
+            {
+                auto write_lock = LockWrite();
+                Write_(batch);
+            }
+            batch.clear();
+            lock.lock();
+
+            spare_.swap(batch);
+            written_count_ = last;
+            writing_ = false;
+            written_.notify_all();
+        }
+    }
+
+private:
+    /**
+     * @brief   Writes records. The write lock is held.
+     * Sinks using Write() override this.
+     * @param   records     the records to write (one or more).
+     */
+    virtual void Write_([[maybe_unused]] std::string const & records) {
+    }
 };
 
 
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_NET_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_NET_HPP
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Creates a socket connected to the given destination.
+ *
+ * All addresses the host resolves to are tried in turn. With SOCK_NONBLOCK in the type
+ * a pending connect is waited for at most the given time.
+ *
+ * @param   host        the host name or address ("localhost" if empty).
+ * @param   port        the port number or service name.
+ * @param   type        the socket type, e.g. SOCK_DGRAM or SOCK_STREAM | SOCK_NONBLOCK.
+ * @param   timeout     milliseconds to wait for a non-blocking connect.
+ * @return  The socket or -1 on failure.
+ */
+inline int ConnectSocket(std::string const & host, std::string const & port, int type, int timeout = 0) {
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type & ~(SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    addrinfo * addresses = nullptr;
+    if (getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (auto address = addresses; (address != nullptr) && (fd < 0); address = address->ai_next) {
+
+        fd = socket(address->ai_family, type | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        auto connected = connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+        if (!connected && (errno == EINPROGRESS)) {
+            pollfd pending{fd, POLLOUT, 0};
+            int error = 0;
+            socklen_t size = sizeof(error);
+            connected = (poll(&pending, 1, timeout) == 1) &&
+                        (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) == 0) && (error == 0);
+        }
+        if (!connected) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+
+    return fd;
+}
+
+
+}
+
+
+#endif
@@ -0,0 +1,388 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "otlp_sink.hpp"
+#include "net.hpp"
+#include "../json.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/logger/formatter.hpp>
+#include <headcode/logger/version.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All OTLPSinks storage.
+ */
+std::map<std::string, std::shared_ptr<OTLPSink>> OTLPSink::Producer::sinks;
+
+
+/**
+ * @brief   All OTLPSinks access synchronization mutex.
+ */
+std::mutex OTLPSink::Producer::mutex;
+
+
+/**
+ * @brief   Default port of OTLP over HTTP.
+ */
+static char const * const kDefaultPort = "4318";
+
+
+/**
+ * @brief   Default path of OTLP logs over HTTP.
+ */
+static char const * const kDefaultPath = "/v1/logs";
+
+
+/**
+ * @brief   Closes the export request after the log records.
+ */
+static char const * const kTail = "]}]}]}";
+
+
+/**
+ * @brief   Timeout of connect in milliseconds.
+ */
+static constexpr int kConnectTimeout = 1000;
+
+
+/**
+ * @brief   Timeout of sending a request and receiving a response.
+ */
+static constexpr timeval kIOTimeout{5, 0};
+
+
+/**
+ * @brief   Minimum retry delay.
+ */
+static constexpr std::chrono::milliseconds kMinBackoff{100};
+
+
+/**
+ * @brief   Maximum retry delay.
+ */
+static constexpr std::chrono::milliseconds kMaxBackoff{10000};
+
+
+/**
+ * @brief   Writes all of the data to a file.
+ * @param   fd          the file descriptor.
+ * @param   data        the data to write.
+ * @return  true, if all data has been written.
+ */
+static bool WriteAll(int fd, std::string const & data) {
+
+    std::size_t done = 0;
+    while (done < data.size()) {
+        auto written = write(fd, data.data() + done, data.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+
+/**
+ * @brief   Adds a resource attribute holding a string.
+ * @param   json        the JSON text to append to.
+ * @param   key         the attribute key.
+ * @param   value       the attribute value.
+ */
+static void AppendAttribute(std::string & json, char const * key, std::string const & value) {
+    json.append(R"({"key":")");
+    json.append(key);
+    json.append(R"(","value":{"stringValue":)");
+    AppendJSONString(json, value);
+    json.append("}}");
+}
+
+
+OTLPSink::OTLPSink(std::string otlp_url) : QueueSink{otlp_url, kDefaultMaxBytes} {
+
+    URL url{otlp_url};
+    if (url.IsValid() && ((url.GetScheme() == "otlp+http") || (url.GetScheme() == "otlp+file"))) {
+
+        file_ = url.GetScheme() == "otlp+file";
+        path_ = std::string{url.GetPath()};
+        if (file_) {
+            fd_ = path_.empty() ? -1 : open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        } else {
+            host_ = std::string{url.GetHost()};
+            port_ = url.GetPort().empty() ? kDefaultPort : std::string{url.GetPort()};
+            if (path_.empty()) {
+                path_ = kDefaultPath;
+            }
+        }
+
+        auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+        batch_ = std::max<std::size_t>(GetURLQuerySize(parameters, "batch", kDefaultBatch), 1);
+        SetBatch(batch_, std::chrono::milliseconds{GetURLQuerySize(parameters, "interval", kDefaultInterval)});
+        SetMaxBytes(GetURLQuerySize(parameters, "queue", kDefaultMaxBytes));
+        SetPriority(GetURLQueryLevel(parameters, "priority", static_cast<int>(Level::kSilent)));
+
+        auto service = parameters.find("service");
+        char host[256] = {0};
+        if (gethostname(host, sizeof(host) - 1) != 0) {
+            host[0] = '\0';
+        }
+
+        head_.append(R"({"resourceLogs":[{"resource":{"attributes":[)");
+        AppendAttribute(head_, "service.name",
+                        (service != parameters.end()) ? service->second : program_invocation_short_name);
+        head_.push_back(',');
+        AppendAttribute(head_, "host.name", host);
+        head_.append(R"(]},"scopeLogs":[{"scope":{"name":"hcs-logger","version":)");
+        AppendJSONString(head_, GetVersionString());
+        head_.append(R"(},"logRecords":[)");
+    }
+
+    SetFormatter(std::make_unique<OTLPFormatter>());
+    Start();
+}
+
+
+OTLPSink::~OTLPSink() {
+    Stop();
+    Disconnect();
+}
+
+
+void OTLPSink::CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) {
+
+    // while the consumer is writing, another writer would garble the lines
+    if (!file_ || (fd_ < 0) || (pending == nullptr) || (pending->empty() && ((queued == nullptr) || queued->empty()))) {
+        return;
+    }
+
+    bool first = true;
+    signal_safe::LineBuffer::Write(fd_, head_.data(), head_.size());
+    for (auto records : {pending, queued}) {
+        if (records == nullptr) {
+            continue;
+        }
+        for (auto const & record : *records) {
+            if (!first) {
+                signal_safe::LineBuffer::Write(fd_, ",", 1);
+            }
+            signal_safe::LineBuffer::Write(fd_, record.data(), record.size());
+            first = false;
+        }
+    }
+    signal_safe::LineBuffer::Write(fd_, kTail, std::strlen(kTail));
+    signal_safe::LineBuffer::Write(fd_, "\n", 1);
+}
+
+
+void OTLPSink::Disconnect() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+
+std::string OTLPSink::GetDescription_() const {
+    if (file_) {
+        return std::string{"OTLPSink to file "} + path_;
+    }
+    return std::string{"OTLPSink to http://"} + host_ + ":" + port_ + path_;
+}
+
+
+int OTLPSink::Post(std::string const & body) {
+
+    auto header = "POST " + path_ + " HTTP/1.1\r\nHost: " + host_ + ":" + port_ +
+                  "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+                  "\r\n\r\n";
+
+    std::size_t done = 0;
+    while (done < header.size() + body.size()) {
+
+        auto header_done = std::min(done, header.size());
+        auto body_done = done - header_done;
+        std::array<iovec, 2> pieces{{{header.data() + header_done, header.size() - header_done},
+                                     {const_cast<char *>(body.data()) + body_done, body.size() - body_done}}};
+
+        msghdr message{};
+        message.msg_iov = pieces.data();
+        message.msg_iovlen = pieces.size();
+        auto sent = sendmsg(fd_, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += static_cast<std::size_t>(sent);
+    }
+
+    // read the response head, then skip the response body
+    std::string response;
+    std::array<char, 4096> buffer;
+    auto head_end = std::string::npos;
+    std::size_t content_length = 0;
+    bool keep_alive = false;
+    while (true) {
+
+        if (head_end == std::string::npos) {
+            head_end = response.find("\r\n\r\n");
+            if (head_end != std::string::npos) {
+                head_end += 4;
+                std::string head = response.substr(0, head_end);
+                std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) {
+                    return static_cast<char>(std::tolower(c));
+                });
+                auto length = head.find("\r\ncontent-length:");
+                keep_alive = (length != std::string::npos) && (head.find("\r\nconnection: close") == std::string::npos);
+                if (length != std::string::npos) {
+                    content_length = std::strtoul(head.c_str() + length + 17, nullptr, 10);
+                }
+            }
+        }
+        if ((head_end != std::string::npos) && (response.size() >= head_end + content_length)) {
+            break;
+        }
+
+        auto received = recv(fd_, buffer.data(), buffer.size(), 0);
+        if ((received < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (received <= 0) {
+            if ((head_end != std::string::npos) && !keep_alive) {
+                break;
+            }
+            return -1;
+        }
+        response.append(buffer.data(), static_cast<std::size_t>(received));
+    }
+
+    int status = -1;
+    if ((response.compare(0, 5, "HTTP/") == 0) && (response.find(' ') != std::string::npos)) {
+        status = std::atoi(response.c_str() + response.find(' ') + 1);
+    }
+    if (!keep_alive) {
+        Disconnect();
+    }
+
+    return (status >= 100) ? status : -1;
+}
+
+
+void OTLPSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<OTLPSink::Producer>());
+    }
+}
+
+
+std::chrono::milliseconds OTLPSink::Send_(std::deque<std::string> & records, bool stopping) {
+
+    if (records.empty()) {
+        return std::chrono::milliseconds{0};
+    }
+
+    if (head_.empty() || (file_ && (fd_ < 0))) {
+        AddDropped(records.size());
+        records.clear();
+        return std::chrono::milliseconds{0};
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!stopping && (now < retry_)) {
+        return std::chrono::ceil<std::chrono::milliseconds>(retry_ - now);
+    }
+
+    while (!records.empty()) {
+
+        auto count = std::min(records.size(), batch_);
+        std::size_t size = head_.size() + 8;
+        for (std::size_t i = 0; i < count; ++i) {
+            size += records[i].size() + 1;
+        }
+
+        std::string body;
+        body.reserve(size);
+        body.append(head_);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                body.push_back(',');
+            }
+            body.append(records[i]);
+        }
+        body.append(kTail);
+
+        if (file_) {
+            body.push_back('\n');
+            if (!WriteAll(fd_, body)) {
+                AddDropped(count);
+            }
+            records.erase(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(count));
+            continue;
+        }
+
+        // a kept alive connection may have been closed by the collector meanwhile: try a new one once
+        int status = -1;
+        for (int attempt = 0; (attempt < 2) && (status < 0); ++attempt) {
+            auto reused = fd_ >= 0;
+            if (!reused) {
+                fd_ = ConnectSocket(host_, port_, SOCK_STREAM | SOCK_NONBLOCK, kConnectTimeout);
+                if (fd_ < 0) {
+                    break;
+                }
+                fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_NONBLOCK);
+                setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &kIOTimeout, sizeof(kIOTimeout));
+                setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &kIOTimeout, sizeof(kIOTimeout));
+            }
+            status = Post(body);
+            if (status < 0) {
+                Disconnect();
+                if (!reused) {
+                    break;
+                }
+            }
+        }
+
+        if ((status < 0) || (status == 429) || (status == 502) || (status == 503) || (status == 504)) {
+            backoff_ = std::clamp(backoff_ * 2, kMinBackoff, kMaxBackoff);
+            retry_ = std::chrono::steady_clock::now() + backoff_;
+            return backoff_;
+        }
+
+        backoff_ = std::chrono::milliseconds{0};
+        if ((status < 200) || (status >= 300)) {
+            AddDropped(count);
+        }
+        records.erase(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+
+    return std::chrono::milliseconds{0};
+}
@@ -0,0 +1,199 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_OTLP_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_OTLP_SINK_HPP
+
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include "queue_sink.hpp"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which exports events as OpenTelemetry logs (OTLP JSON).
+ *
+ * Events are formatted as OTLP log records (see OTLPFormatter) on the logging thread and
+ * queued. A thread of the sink collects them into batches (by number of records and time)
+ * and exports each batch as one ExportLogsServiceRequest: either by a HTTP/1.1 POST to an
+ * OpenTelemetry collector over a persistent connection or as a line of a JSON-lines file
+ * (as read by the collector's "otlpjsonfile" receiver).
+ *
+ * Batches the collector refuses for a while (connection errors, 429, 502, 503, 504) are
+ * kept and sent again with exponential backoff (100 ms up to 10 s). Batches the collector
+ * rejects (any other status) are dropped and counted (see QueueSink::GetDropped()).
+ *
+ * URLs: "otlp+http://HOST:PORT/PATH" (PATH defaults to "/v1/logs"), "otlp+file:PATH"
+ *
+ * URL query parameters:
+ *      batch=RECORDS       records per export request (default 512)
+ *      interval=MS         maximum wait for a full batch in milliseconds (default 1000)
+ *      queue=BYTES         byte budget of the queue (default 4 MiB)
+ *      priority=LEVEL      events of this level or above take the fast lane (default silent: off, see QueueSink)
+ *      service=NAME        the "service.name" resource attribute (default: program name)
+ *
+ * On a crash the records left are written to the file as a last export request; they are
+ * not sent over HTTP.
+ *
+ * There is no TLS: use a collector (or agent) on the local host or within a trusted network.
+ * Changing the formatter of this sink breaks the export requests.
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("otlp+http://localhost:4318/v1/logs?batch=256");
+ *      headcode::logger::Logger::GetLogger()->AddSink(sink);
+ * @endcode
+ */
+class OTLPSink : public QueueSink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<OTLPSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<OTLPSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "OTLPSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return (parsed_url.GetScheme() == "otlp+http") || (parsed_url.GetScheme() == "otlp+file");
+        }
+    };
+
+    /**
+     * @brief   Default number of records per export request.
+     */
+    static constexpr std::size_t kDefaultBatch = 512;
+
+    /**
+     * @brief   Default maximum wait for a full batch in milliseconds.
+     */
+    static constexpr std::size_t kDefaultInterval = 1000;
+
+    std::string host_;                                  //!< @brief The host to connect to.
+    std::string port_;                                  //!< @brief The port to connect to.
+    std::string path_;                                  //!< @brief The HTTP path or the file name.
+    bool file_{false};                                  //!< @brief Export to a file instead of HTTP.
+    std::size_t batch_{kDefaultBatch};                  //!< @brief Records per export request.
+    std::string head_;                                  //!< @brief Export request up to the records.
+    int fd_{-1};                                        //!< @brief The connection or the file.
+    std::chrono::milliseconds backoff_{0};              //!< @brief Current retry delay.
+    std::chrono::steady_clock::time_point retry_;       //!< @brief Earliest time for the next export.
+
+public:
+    /**
+     * @brief   Constructs a sink which exports the events as OpenTelemetry logs.
+     * @param   otlp_url        URL of the collector or the file.
+     */
+    explicit OTLPSink(std::string otlp_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~OTLPSink() override;
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Writes the records left to the file on a crash.
+     * @param   pending         records taken by the consumer (oldest first); nullptr if busy.
+     * @param   queued          records queued after these; nullptr if busy.
+     */
+    void CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) override;
+
+    /**
+     * @brief   Closes the connection.
+     */
+    void Disconnect();
+
+    /**
+     * @brief   Posts an export request and reads the response.
+     * @param   body            the export request.
+     * @return  The HTTP status; -1 on connection errors.
+     */
+    int Post(std::string const & body);
+
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   Exports the records in batches.
+     * @param   records         the records to export, oldest first.
+     * @param   stopping        the sink is about to be destroyed.
+     * @return  Time to wait before the records left are exported again.
+     */
+    std::chrono::milliseconds Send_(std::deque<std::string> & records, bool stopping) override;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "queue_sink.hpp"
+#include "../crash_registry.hpp"
+#include "../signal_safe.hpp"
+#include "../worker_thread.hpp"
+
+#include <headcode/logger/event.hpp>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   Takes a spin lock guarding against the crash handler (which never releases it).
+ * @param   lock        the spin lock.
+ */
+static void Acquire(std::atomic_flag & lock) {
+    while (lock.test_and_set(std::memory_order_acquire)) {
+    }
+}
+
+
+/**
+ * @brief   Releases a spin lock.
+ * @param   lock        the spin lock.
+ */
+static void Release(std::atomic_flag & lock) {
+    lock.clear(std::memory_order_release);
+}
+
+
+QueueSink::QueueSink(std::string url, std::size_t max_bytes)
+        : Sink{std::move(url)}, max_bytes_{max_bytes}, priority_level_{static_cast<int>(Level::kSilent)} {
+}
+
+
+QueueSink::~QueueSink() {
+    Stop();
+}
+
+
+void QueueSink::CrashFlush(void * context) {
+    auto sink = static_cast<QueueSink *>(context);
+    auto pending = signal_safe::TryLock(sink->pending_guard_) ? &sink->pending_ : nullptr;
+    auto queued = signal_safe::TryLock(sink->queue_guard_) ? &sink->queue_ : nullptr;
+    sink->CrashSend_(pending, queued);
+}
+
+
+bool QueueSink::Flush_(std::chrono::steady_clock::time_point deadline) {
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+    if (bytes_ == 0) {
+        return true;
+    }
+
+    // the consumer takes all records queued now with its next round and sends the records
+    // taken in order: wait for that round, then until the records taken up to there are done
+    ++flushing_;
+    wakeup_.Notify();
+    auto round = rounds_ + (queue_.empty() ? 0 : 1);
+    auto flushed = drained_.wait_until(lock, deadline, [&]() { return (rounds_ >= round) || stop_; });
+    auto watermark = taken_;
+    flushed = flushed && drained_.wait_until(lock, deadline, [&]() { return (done_ >= watermark) || stop_; });
+    --flushing_;
+
+    return flushed && (done_ >= watermark);
+}
+
+
+void QueueSink::Log_(Event const & event) {
+
+    std::string record = Format(event);
+    Frame_(record);
+
+    bool wakeup = false;
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        auto urgent = (event.GetLevel() > 0) && (event.GetLevel() <= priority_level_);
+        if (!urgent && ((record.size() > max_bytes_) || (bytes_ > max_bytes_ - record.size()))) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        bytes_ += record.size();
+        Acquire(queue_guard_);
+        if (urgent) {
+            queue_.insert(queue_.begin() + static_cast<std::ptrdiff_t>(priority_records_), std::move(record));
+            ++priority_records_;
+        } else {
+            queue_.push_back(std::move(record));
+        }
+        Release(queue_guard_);
+        wakeup = waiting_ && (urgent || (queue_.size() == 1) || (queue_.size() >= batch_records_));
+    }
+
+    if (wakeup) {
+        wakeup_.Notify();
+    }
+}
+
+
+void QueueSink::Run() {
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+    std::chrono::milliseconds delay{0};
+    std::size_t pending_bytes = 0;
+
+    while (true) {
+
+        waiting_ = true;
+        if (pending_.empty()) {
+            WaitUntil(lock, std::chrono::steady_clock::time_point::max(), [&]() { return !queue_.empty() || stop_; });
+            if (batch_records_ > 1) {
+                WaitUntil(lock, std::chrono::steady_clock::now() + batch_interval_, [&]() {
+                    return (queue_.size() >= batch_records_) || (priority_records_ > 0) || (flushing_ > 0) || stop_;
+                });
+            }
+        } else if (delay.count() > 0) {
+            // back off: new records do not make the peer come back earlier
+            WaitUntil(lock, std::chrono::steady_clock::now() + delay, [&]() { return stop_; });
+        }
+        waiting_ = false;
+
+        auto stopping = stop_;
+        Acquire(pending_guard_);
+        Acquire(queue_guard_);
+        for (auto & record : queue_) {
+            pending_bytes += record.size();
+            pending_.push_back(std::move(record));
+        }
+        taken_ += queue_.size();
+        ++rounds_;
+        queue_.clear();
+        priority_records_ = 0;
+        Release(queue_guard_);
+
+        auto pending_records = pending_.size();
+        lock.unlock();
+        delay = Send_(pending_, stopping);
+        std::size_t left_bytes = 0;
+        for (auto const & record : pending_) {
+            left_bytes += record.size();
+        }
+        lock.lock();
+
+        bytes_ -= pending_bytes - left_bytes;
+        pending_bytes = left_bytes;
+        done_ += pending_records - pending_.size();
+        if (flushing_ > 0) {
+            drained_.notify_all();
+        }
+
+        if (stopping) {
+            AddDropped(pending_.size());
+            done_ += pending_.size();
+            pending_.clear();
+            bytes_ -= pending_bytes;
+            Release(pending_guard_);
+            drained_.notify_all();
+            break;
+        }
+        Release(pending_guard_);
+    }
+}
+
+
+void QueueSink::Start() {
+    // the worker is named by the URL scheme, e.g. "hcs-udp"
+    consumer_ = StartWorker(GetURL().substr(0, GetURL().find(':')), [this]() { Run(); });
+    RegisterCrashFlusher(&QueueSink::CrashFlush, this);
+}
+
+
+void QueueSink::Stop() {
+
+    UnregisterCrashFlusher(this);
+
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        stop_ = true;
+    }
+    wakeup_.Notify();
+
+    if (consumer_.joinable()) {
+        consumer_.join();
+    }
+}
+
+
+template <typename Predicate>
+bool QueueSink::WaitUntil(std::unique_lock<std::mutex> & lock,
+                          std::chrono::steady_clock::time_point deadline,
+                          Predicate predicate) {
+
+    // the sequence is taken with the lock held: a record queued after the check bumps it
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        auto sequence = wakeup_.GetSequence();
+        lock.unlock();
+        wakeup_.Wait(sequence, deadline);
+        lock.lock();
+    }
+    return true;
+}
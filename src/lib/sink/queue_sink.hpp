@@ -0,0 +1,230 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_QUEUE_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_QUEUE_SINK_HPP
+
+#include <headcode/logger/sink.hpp>
+
+#include "../wakeup.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Base of sinks doing their I/O on a thread of their own (e.g. network sinks).
+ *
+ * The logging thread only formats the event and appends the text to a queue. A consumer
+ * thread takes all queued records at once and hands them to Send_(). Records Send_() could
+ * not get rid of stay at the front of the queue and are tried again later.
+ *
+ * The queue is bounded by a byte budget: while it is exhausted (the peer is slow or gone)
+ * new records are dropped and counted (see GetDropped()). Logging never blocks on I/O.
+ *
+ * Urgent records (events of the priority level or above, see SetPriority(); off by default)
+ * take a fast lane: they are queued ahead of the records not yet taken by the consumer,
+ * wake the consumer at once without waiting for a full batch and are never dropped for the
+ * byte budget. Among themselves they keep their order. Records already taken by the
+ * consumer are not overtaken. Receivers see urgent records out of order: formats carrying
+ * the events' sequence numbers (GELF, OTLP; see Event::GetSequence()) let them restore it.
+ *
+ * Sinks sending batches (see SetBatch()) let the consumer wait until a batch is full or
+ * the first record of the batch waited long enough. Flush() does not wait for a full batch:
+ * it waits until the consumer got rid of the records queued before (or the deadline is
+ * reached). Records queued while flushing are not waited for.
+ *
+ * Derived classes call Start() at the end of their constructor and Stop() at the start of
+ * their destructor, as Send_() must not run on a half built or half destroyed object.
+ *
+ * When the process crashes (see InstallCrashHandler()), the records pending and queued are
+ * handed to CrashSend_(), unless another thread is changing them right then.
+ */
+class QueueSink : public Sink {
+
+    std::size_t max_bytes_;                              //!< @brief Byte budget of the queue.
+    std::size_t bytes_{0};                               //!< @brief Bytes queued or pending.
+    std::size_t batch_records_{1};                       //!< @brief Records making a full batch.
+    std::chrono::milliseconds batch_interval_{0};        //!< @brief Maximum wait for a full batch.
+    std::deque<std::string> queue_;                      //!< @brief Records queued by loggers.
+    std::deque<std::string> pending_;                    //!< @brief Records taken by the consumer.
+    std::atomic<std::uint64_t> dropped_{0};              //!< @brief Records dropped so far.
+    bool stop_{false};                                   //!< @brief Consumer shall stop.
+    bool waiting_{false};                                //!< @brief Consumer is waiting for records.
+    int priority_level_;                                 //!< @brief Events up to this level are urgent.
+    std::size_t priority_records_{0};                    //!< @brief Urgent records at the front of queue_.
+    unsigned int flushing_{0};                           //!< @brief Number of threads waiting in Flush_().
+    std::uint64_t rounds_{0};                            //!< @brief Times the consumer took the queue.
+    std::uint64_t taken_{0};                             //!< @brief Records taken by the consumer so far.
+    std::uint64_t done_{0};                              //!< @brief Records taken and sent (or dropped) so far.
+    std::mutex mutex_;                                   //!< @brief Guards all of the above.
+    std::atomic_flag queue_guard_ = ATOMIC_FLAG_INIT;    //!< @brief Held while queue_ changes (for crashes).
+    std::atomic_flag pending_guard_ = ATOMIC_FLAG_INIT;  //!< @brief Held while pending_ changes (for crashes).
+    Wakeup wakeup_;                                      //!< @brief Wakes the consumer.
+    std::condition_variable drained_;                    //!< @brief Signals progress of the consumer to Flush_().
+    std::thread consumer_;                               //!< @brief The consumer thread.
+
+public:
+    /**
+     * @brief   Destructor.
+     */
+    ~QueueSink() override;
+
+    /**
+     * @brief   Gets the number of records dropped because the byte budget was exhausted.
+     * @return  The number of dropped records.
+     */
+    [[nodiscard]] std::uint64_t GetDropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+protected:
+    /**
+     * @brief   Default byte budget of the queue.
+     */
+    static constexpr std::size_t kDefaultMaxBytes = 4 * 1024 * 1024;
+
+    /**
+     * @brief   Constructor.
+     * @param   url             the url by which this sink will be identified.
+     * @param   max_bytes       byte budget of the queue.
+     */
+    QueueSink(std::string url, std::size_t max_bytes);
+
+    /**
+     * @brief   Counts records dropped by derived classes (e.g. failed sends).
+     * @param   count           the number of dropped records.
+     */
+    void AddDropped(std::uint64_t count) {
+        dropped_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Lets the consumer collect batches of records.
+     * @param   records         the number of records making a full batch.
+     * @param   interval        the maximum time to wait for a full batch.
+     */
+    void SetBatch(std::size_t records, std::chrono::milliseconds interval) {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        batch_records_ = std::max<std::size_t>(records, 1);
+        batch_interval_ = interval;
+    }
+
+    /**
+     * @brief   Sets the byte budget of the queue.
+     * @param   max_bytes       byte budget of the queue.
+     */
+    void SetMaxBytes(std::size_t max_bytes) {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        max_bytes_ = max_bytes;
+    }
+
+    /**
+     * @brief   Sets the level up to which events take the fast lane (see description).
+     * @param   level           the priority level; 0 turns the fast lane off.
+     */
+    void SetPriority(int level) {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        priority_level_ = level;
+    }
+
+    /**
+     * @brief   Starts the consumer thread.
+     */
+    void Start();
+
+    /**
+     * @brief   Stops the consumer thread.
+     * Records queued are handed to Send_() one last time.
+     */
+    void Stop();
+
+private:
+    /**
+     * @brief   Writes out the records on a crash.
+     * @param   context         the sink.
+     */
+    static void CrashFlush(void * context);
+
+    /**
+     * @brief   Waits until all records queued so far have been sent.
+     * @param   deadline    the latest time to return.
+     * @return  true, if the queue has been drained.
+     */
+    bool Flush_(std::chrono::steady_clock::time_point deadline) override;
+
+    /**
+     * @brief   Writes out records when the process crashes. This runs in a signal handler.
+     * Only async-signal-safe functions may be used and no memory may be allocated. The
+     * default does nothing.
+     * @param   pending         records taken by the consumer (oldest first); nullptr if busy.
+     * @param   queued          records queued after these; nullptr if busy.
+     */
+    virtual void CrashSend_([[maybe_unused]] std::deque<std::string> const * pending,
+                            [[maybe_unused]] std::deque<std::string> const * queued) {
+    }
+
+    /**
+     * @brief   Formats and queues the event.
+     * @param   event       the event to log.
+     */
+    void Log_(Event const & event) override;
+
+    /**
+     * @brief   Adds framing to a formatted record before it is queued (e.g. a length prefix).
+     * This runs on the logging thread. The default does nothing.
+     * @param   record          the record to frame.
+     */
+    virtual void Frame_([[maybe_unused]] std::string & record) const {
+    }
+
+    /**
+     * @brief   The consumer thread's loop.
+     */
+    void Run();
+
+    /**
+     * @brief   Lets the consumer wait for a condition (see Wakeup).
+     * @param   lock            the lock of mutex_, held.
+     * @param   deadline        the latest time to return.
+     * @param   predicate       the condition waited for; checked with the lock held.
+     * @return  The predicate's value on return.
+     */
+    template <typename Predicate>
+    bool WaitUntil(std::unique_lock<std::mutex> & lock,
+                   std::chrono::steady_clock::time_point deadline,
+                   Predicate predicate);
+
+    /**
+     * @brief   Sends records. This runs on the consumer thread.
+     * Sent (or dropped) records are removed from the front of the given queue.
+     * @param   records         the records to send, oldest first.
+     * @param   stopping        the sink is about to be destroyed: do not wait for anything.
+     * @return  Time to wait before records left are tried again.
+     */
+    virtual std::chrono::milliseconds Send_(std::deque<std::string> & records, bool stopping) = 0;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "ring_sink.hpp"
+#include "../crash_registry.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/logger/event.hpp>
+#include <headcode/logger/logger_core.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <fcntl.h>
+
+#include <algorithm>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All RingSinks storage.
+ */
+std::map<std::string, std::shared_ptr<RingSink>> RingSink::Producer::sinks;
+
+
+/**
+ * @brief   All RingSinks access synchronization mutex.
+ */
+std::mutex RingSink::Producer::mutex;
+
+
+/**
+ * @brief   Default number of events kept.
+ */
+static constexpr std::size_t kDefaultEvents = 1000;
+
+
+/**
+ * @brief   Default number of message bytes kept.
+ */
+static constexpr std::size_t kDefaultBytes = 256 * 1024;
+
+
+RingSink::RingSink(std::string ring_url) : Sink{ring_url}, dump_level_{static_cast<int>(Level::kCritical)} {
+
+    std::string query;
+    URL url{ring_url};
+    if (url.IsValid() && (url.GetScheme() == "ring")) {
+        query = std::string{url.GetQuery()};
+    }
+
+    // the target URL may have a query on its own: it takes all the rest
+    target_url_ = "stderr:";
+    auto target = query.find("target=");
+    while ((target != std::string::npos) && (target != 0) && (query[target - 1] != '&')) {
+        target = query.find("target=", target + 1);
+    }
+    if (target != std::string::npos) {
+        target_url_ = query.substr(target + 7);
+        query.erase(target);
+    }
+
+    auto parameters = ParseURLQuery(query);
+    entries_.resize(std::max<std::size_t>(GetURLQuerySize(parameters, "events", kDefaultEvents), 1));
+    bytes_.resize(std::max<std::size_t>(GetURLQuerySize(parameters, "bytes", kDefaultBytes), 1));
+    auto dump = parameters.find("dump");
+    if (dump != parameters.end()) {
+        if (dump->second == "none") {
+            dump_level_ = 0;
+        } else {
+            ParseURLQueryLevel(dump->second, dump_level_);
+        }
+    }
+
+    target_ = SinkFactory::Create(target_url_);
+    URL target_url{target_url_};
+    if (target_url.GetScheme() == "stdout") {
+        crash_fd_ = 1;
+    } else if (target_url.GetScheme() == "file") {
+        // text lines must not end up in binary logs or traces (format=...): these go to stderr
+        auto target_parameters = ParseURLQuery(std::string{target_url.GetQuery()});
+        if (target_parameters.find("format") == target_parameters.end()) {
+            crash_path_ = target_url.GetPath().empty() ? std::string{"a.log"} : std::string{target_url.GetPath()};
+        }
+    }
+
+    RegisterCrashFlusher(&RingSink::CrashFlush, this);
+}
+
+
+RingSink::~RingSink() {
+    UnregisterCrashFlusher(this);
+}
+
+
+void RingSink::CrashFlush(void * context) {
+
+    auto sink = static_cast<RingSink *>(context);
+
+    // the crashing thread may hold the lock: wait a bit, then go on anyway
+    for (int i = 0; (i < 10000) && sink->lock_.test_and_set(std::memory_order_acquire); ++i) {
+    }
+
+    auto fd = sink->crash_fd_;
+    if (!sink->crash_path_.empty()) {
+        fd = open(sink->crash_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            fd = 2;
+        }
+    }
+
+    signal_safe::LineBuffer line;
+    auto capacity = sink->bytes_.size();
+    for (std::size_t i = 0; i < sink->count_; ++i) {
+
+        auto const & entry = sink->entries_[(sink->first_ + i) % sink->entries_.size()];
+        signal_safe::LineBuffer prefix;
+        prefix.Append("[", 1);
+        prefix.AppendTime(
+                std::chrono::duration_cast<std::chrono::microseconds>(entry.time_point_.time_since_epoch()).count());
+        prefix.Append("] ", 2);
+        prefix.AppendLevel(entry.level_);
+        if ((entry.logger_ != nullptr) && !entry.logger_->GetRawName().empty()) {
+            prefix.Append(" {", 2);
+            prefix.Append(entry.logger_->GetRawName().data(), entry.logger_->GetRawName().size());
+            prefix.Append("}", 1);
+        }
+        prefix.Append(": ", 2);
+
+        // one line per line of the message, like the StandardFormatter
+        bool line_start = true;
+        for (std::size_t j = 0; j < entry.size_; ++j) {
+            if (line_start) {
+                line.Append(prefix.GetData(), prefix.GetSize());
+                line_start = false;
+            }
+            auto c = sink->bytes_[(entry.offset_ + j) % capacity];
+            line.Append(&c, 1);
+            if (c == '\n') {
+                line.Flush(fd);
+                line_start = true;
+            }
+        }
+        if (!line_start || (entry.size_ == 0)) {
+            if (entry.size_ == 0) {
+                line.Append(prefix.GetData(), prefix.GetSize());
+            }
+            line.Append("\n", 1);
+            line.Flush(fd);
+        }
+    }
+
+    if (fd > 2) {
+        close(fd);
+    }
+}
+
+
+void RingSink::Dump_() {
+
+    struct Stored {
+        Entry entry_;
+        std::string message_;
+    };
+    std::vector<Stored> stored;
+
+    Lock();
+    stored.reserve(count_);
+    auto capacity = bytes_.size();
+    while (count_ > 0) {
+        auto const & entry = entries_[first_];
+        std::string message;
+        message.reserve(entry.size_);
+        auto first_part = std::min(entry.size_, capacity - entry.offset_);
+        message.append(bytes_.data() + entry.offset_, first_part);
+        message.append(bytes_.data(), entry.size_ - first_part);
+        stored.push_back(Stored{entry, std::move(message)});
+        PopFront();
+    }
+    Unlock();
+
+    if (!target_) {
+        return;
+    }
+    for (auto const & s : stored) {
+        Event event{s.entry_.time_point_, s.entry_.level_, s.entry_.logger_, s.entry_.thread_id_, s.message_};
+        target_->Log(event);
+    }
+}
+
+
+bool RingSink::Flush_(std::chrono::steady_clock::time_point deadline) {
+    return !target_ || target_->Flush(deadline);
+}
+
+
+std::string RingSink::GetDescription_() const {
+    return std::string{"RingSink to "} + target_url_;
+}
+
+
+void RingSink::Log_(Event const & event) {
+
+    // copied straight from the event's buffer: storing an event allocates nothing
+    auto message = event.GetMessageView();
+    auto capacity = bytes_.size();
+    auto size = std::min(message.size(), capacity);
+
+    Lock();
+
+    while ((count_ > 0) && ((count_ == entries_.size()) || (bytes_used_ + size > capacity))) {
+        PopFront();
+    }
+
+    auto offset = (bytes_first_ + bytes_used_) % capacity;
+    auto first_part = std::min(size, capacity - offset);
+    std::copy(message.data(), message.data() + first_part, bytes_.data() + offset);
+    std::copy(message.data() + first_part, message.data() + size, bytes_.data());
+    bytes_used_ += size;
+
+    auto & entry = entries_[(first_ + count_) % entries_.size()];
+    entry.time_point_ = event.GetTimePoint();
+    entry.level_ = event.GetLevel();
+    entry.logger_ = const_cast<Logger *>(event.GetLogger());        // loggers are owned by the registry
+    entry.thread_id_ = event.GetThreadId();
+    entry.offset_ = offset;
+    entry.size_ = size;
+    ++count_;
+
+    Unlock();
+
+    auto level = event.GetLevel();
+    if ((level > 0) && (level <= dump_level_)) {
+        Dump_();
+    }
+}
+
+
+void RingSink::PopFront() {
+    auto const & entry = entries_[first_];
+    bytes_first_ = (entry.offset_ + entry.size_) % bytes_.size();
+    bytes_used_ -= entry.size_;
+    first_ = (first_ + 1) % entries_.size();
+    --count_;
+    if (count_ == 0) {
+        bytes_first_ = 0;
+        bytes_used_ = 0;
+    }
+}
+
+
+void RingSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<RingSink::Producer>());
+    }
+}
@@ -0,0 +1,225 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_RING_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_RING_SINK_HPP
+
+#include <headcode/logger/sink.hpp>
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+class Logger;        //!< @brief Forward declaration of a logger.
+
+
+/**
+ * @brief   A flight recorder: keeps the most recent events in memory.
+ *
+ * All events reaching this sink are stored unformatted in preallocated memory. Only
+ * when needed these are written to the target sink:
+ *
+ *  - an event at or above the dump level (default: Critical) arrives,
+ *  - Sink::Dump() is called, or
+ *  - the process crashes and InstallCrashHandler() has been called (see crash.hpp).
+ *
+ * This way Debug events leading up to a failure can be kept at nearly no cost
+ * without writing them all to disk.
+ *
+ * URL query parameters:
+ *      events=N            keep at most N events (default 1000)
+ *      bytes=N             keep at most N message bytes (default 256 KiB)
+ *      dump=LEVEL          dump on events of this level or more severe (default critical, "none" for never)
+ *      target=URL          the sink to dump to (default "stderr:"); this must be the last parameter
+ *
+ * Events are dumped with the formatter of the target sink, except on a crash: then the
+ * events are written in the StandardFormatter layout with async-signal-safe code directly
+ * to stderr, stdout or the file of the target ("file:" URL without a format parameter;
+ * stderr for all other targets, e.g. binary logs).
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("ring:?events=5000&target=file:crash.log");
+ *      headcode::logger::Logger::GetLogger()->AddSink(sink);
+ *      headcode::logger::Logger::GetLogger()->SetBarrier(headcode::logger::Level::kDebug);
+ * @endcode
+ */
+class RingSink : public Sink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<RingSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<RingSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "RingSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return parsed_url.GetScheme() == "ring";
+        }
+    };
+
+    /**
+     * @brief   An event stored.
+     */
+    struct Entry {
+        std::chrono::system_clock::time_point time_point_;        //!< @brief When the event happened.
+        int level_{0};                                            //!< @brief Log level value.
+        Logger * logger_{nullptr};                                //!< @brief The logger of the event.
+        std::uint64_t thread_id_{0};                              //!< @brief The thread of the event.
+        std::size_t offset_{0};                                   //!< @brief Start of the message in bytes_.
+        std::size_t size_{0};                                     //!< @brief Size of the message.
+    };
+
+    std::vector<Entry> entries_;                 //!< @brief The events stored (circular).
+    std::size_t first_{0};                       //!< @brief Index of the oldest event in entries_.
+    std::size_t count_{0};                       //!< @brief Number of events stored.
+    std::vector<char> bytes_;                    //!< @brief The messages of the events stored (circular).
+    std::size_t bytes_first_{0};                 //!< @brief Offset of the oldest message in bytes_.
+    std::size_t bytes_used_{0};                  //!< @brief Number of message bytes stored.
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;        //!< @brief Guards the storage.
+
+    int dump_level_;                             //!< @brief Dump on events at or above this level.
+    std::string target_url_;                     //!< @brief URL of the sink to dump to.
+    std::shared_ptr<Sink> target_;               //!< @brief The sink to dump to.
+    int crash_fd_{2};                            //!< @brief File descriptor to write to on a crash.
+    std::string crash_path_;                     //!< @brief File to write to on a crash (if not empty).
+
+public:
+    /**
+     * @brief   Constructs a flight recorder sink.
+     * @param   ring_url        URL of the sink.
+     */
+    explicit RingSink(std::string ring_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~RingSink() override;
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Writes the events stored with async-signal-safe code.
+     * @param   context     the RingSink instance.
+     */
+    static void CrashFlush(void * context);
+
+    /**
+     * @brief   Writes the events stored to the target and clears the storage.
+     */
+    void Dump_() override;
+
+    /**
+     * @brief   Flushes the target. The events stored stay where they are.
+     * @param   deadline    the latest time to return.
+     * @return  true, if the target has been flushed.
+     */
+    bool Flush_(std::chrono::steady_clock::time_point deadline) override;
+
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   Acquires the storage lock.
+     */
+    void Lock() {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief   This does the actual logging.
+     * @param   event       the event to log.
+     */
+    void Log_(Event const & event) override;
+
+    /**
+     * @brief   Removes the oldest event from storage.
+     */
+    void PopFront();
+
+    /**
+     * @brief   Releases the storage lock.
+     */
+    void Unlock() {
+        lock_.clear(std::memory_order_release);
+    }
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "shm_sink.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/url/url.hpp>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All ShmSinks storage.
+ */
+std::map<std::string, std::shared_ptr<ShmSink>> ShmSink::Producer::sinks;
+
+
+/**
+ * @brief   All ShmSinks access synchronization mutex.
+ */
+std::mutex ShmSink::Producer::mutex;
+
+
+ShmSink::ShmSink(std::string shm_url) : Sink{shm_url} {
+
+    URL url{shm_url};
+    if (!url.IsValid() || (url.GetScheme() != "shm")) {
+        return;
+    }
+
+    name_ = ShmRing::GetObjectName(std::string{url.GetPath()});
+    auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+    ring_ = ShmRing::Create(name_,
+                            GetURLQuerySize(parameters, "size", kRingDefaultSize),
+                            GetURLQuerySize(parameters, "slot", kRingDefaultSlotSize));
+
+    auto format = parameters.find("format");
+    if ((format != parameters.end()) && (format->second == "binary")) {
+        SetFormatter(std::make_unique<BinaryFormatter>());
+        ordered_ = true;
+    }
+}
+
+
+std::string ShmSink::GetDescription_() const {
+    return std::string{"ShmSink to "} + name_;
+}
+
+
+void ShmSink::Log_(Event const & event) {
+
+    if (!ring_) {
+        return;
+    }
+
+    // stateful formatters (like the BinaryFormatter) need their output in the order produced
+    if (ordered_) {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        ring_->Write(Format(event));
+        return;
+    }
+
+    ring_->Write(Format(event));
+}
+
+
+void ShmSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<ShmSink::Producer>());
+    }
+}
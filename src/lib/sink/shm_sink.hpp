@@ -0,0 +1,145 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_SHM_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_SHM_SINK_HPP
+
+#include <headcode/logger/sink.hpp>
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include "../shm_ring.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which writes all event messages into a ring buffer in shared memory.
+ *
+ * The actual I/O is done by another process draining the ring (e.g. `hcs-logcollect app`
+ * or a ShmRingReader). Logging never waits for that process: if it falls behind or is not
+ * running at all, the oldest records in the ring are overwritten.
+ *
+ * URL: "shm:NAME" with NAME being the name of the shared memory object ("/dev/shm/NAME").
+ * If the object already exists it is used as it is.
+ *
+ * URL query parameters:
+ *      size=BYTES          size of the ring (default 1 MiB)
+ *      slot=BYTES          size of a slot (default 256); longer records span several slots
+ *      format=binary       use a BinaryFormatter
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("shm:app?size=4194304");
+ *      headcode::logger::Logger::GetLogger()->SetSink(sink);
+ * @endcode
+ */
+class ShmSink : public Sink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<ShmSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<ShmSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "ShmSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return parsed_url.GetScheme() == "shm";
+        }
+    };
+
+    std::string name_;                        //!< @brief Name of the shared memory object.
+    std::unique_ptr<ShmRing> ring_;           //!< @brief The ring; nullptr if it could not be mapped.
+    bool ordered_{false};                     //!< @brief Formatting and writing must not interleave.
+    std::mutex mutex_;                        //!< @brief Serializes formatting and writing if ordered_.
+
+public:
+    /**
+     * @brief   Constructs a sink which pushes the log messages into a shared memory ring.
+     * @param   shm_url         URL of the ring.
+     */
+    explicit ShmSink(std::string shm_url);
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   This does the actual logging.
+     * @param   event       the event to log.
+     */
+    void Log_(Event const & event) override;
+};
+
+
+}
+
+
+#endif
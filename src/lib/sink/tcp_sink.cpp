@@ -0,0 +1,248 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "tcp_sink.hpp"
+#include "net.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All TCPSinks storage.
+ */
+std::map<std::string, std::shared_ptr<TCPSink>> TCPSink::Producer::sinks;
+
+
+/**
+ * @brief   All TCPSinks access synchronization mutex.
+ */
+std::mutex TCPSink::Producer::mutex;
+
+
+/**
+ * @brief   First delay before connecting again.
+ */
+static constexpr std::chrono::milliseconds kMinBackoff{100};
+
+
+/**
+ * @brief   Maximum delay before connecting again.
+ */
+static constexpr std::chrono::milliseconds kMaxBackoff{10000};
+
+
+/**
+ * @brief   Milliseconds to wait for a connect.
+ */
+static constexpr int kConnectTimeout = 1000;
+
+
+/**
+ * @brief   Milliseconds to wait for a writable connection before looking for new records.
+ */
+static constexpr int kWriteTimeout = 100;
+
+
+/**
+ * @brief   Maximum number of records passed to a single sendmsg(2) call.
+ */
+static constexpr std::size_t kBatchSize = 64;
+
+
+TCPSink::TCPSink(std::string tcp_url) : QueueSink{tcp_url, kDefaultMaxBytes} {
+
+    URL url{tcp_url};
+    auto gelf = url.GetScheme() == "gelf+tcp";
+    if (url.IsValid() && ((url.GetScheme() == "tcp") || gelf) && !url.GetPort().empty()) {
+        host_ = std::string{url.GetHost()};
+        port_ = std::string{url.GetPort()};
+
+        auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+        auto framing = parameters.find("framing");
+        if ((framing != parameters.end()) && (framing->second == "length")) {
+            framing_ = Framing::kLength;
+        }
+        if (gelf) {
+            SetFormatter(std::make_unique<GELFFormatter>());
+            framing_ = Framing::kNull;
+        }
+        SetMaxBytes(GetURLQuerySize(parameters, "queue", kDefaultMaxBytes));
+        SetPriority(GetURLQueryLevel(parameters, "priority", static_cast<int>(Level::kSilent)));
+    }
+
+    Start();
+}
+
+
+TCPSink::~TCPSink() {
+    Stop();
+    Disconnect();
+}
+
+
+void TCPSink::CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) {
+
+    // while the consumer is sending, another writer would garble the stream
+    if ((pending == nullptr) || (socket_ < 0)) {
+        return;
+    }
+
+    auto offset = offset_;
+    for (auto records : {pending, queued}) {
+        if (records == nullptr) {
+            return;
+        }
+        for (auto const & record : *records) {
+            if (!signal_safe::Send(socket_, record.data() + offset, record.size() - offset)) {
+                return;
+            }
+            offset = 0;
+        }
+    }
+}
+
+
+void TCPSink::Disconnect() {
+    if (socket_ >= 0) {
+        close(socket_);
+        socket_ = -1;
+    }
+    offset_ = 0;
+}
+
+
+void TCPSink::Frame_(std::string & record) const {
+
+    if (framing_ == Framing::kLength) {
+        auto size = static_cast<std::uint32_t>(record.size());
+        char prefix[4] = {static_cast<char>(size >> 24),
+                          static_cast<char>(size >> 16),
+                          static_cast<char>(size >> 8),
+                          static_cast<char>(size)};
+        record.insert(0, prefix, sizeof(prefix));
+        return;
+    }
+
+    if (framing_ == Framing::kNull) {
+        record.push_back('\0');
+        return;
+    }
+
+    if (record.empty() || (record.back() != '\n')) {
+        record.push_back('\n');
+    }
+}
+
+
+std::string TCPSink::GetDescription_() const {
+    return std::string{"TCPSink to "} + host_ + ":" + port_;
+}
+
+
+void TCPSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<TCPSink::Producer>());
+    }
+}
+
+
+std::chrono::milliseconds TCPSink::Send_(std::deque<std::string> & records, bool stopping) {
+
+    if (records.empty()) {
+        return std::chrono::milliseconds{0};
+    }
+
+    if (port_.empty()) {
+        AddDropped(records.size());
+        records.clear();
+        return std::chrono::milliseconds{0};
+    }
+
+    if (socket_ < 0) {
+
+        auto now = std::chrono::steady_clock::now();
+        if (!stopping && (now < retry_)) {
+            return std::chrono::ceil<std::chrono::milliseconds>(retry_ - now);
+        }
+
+        socket_ = ConnectSocket(host_, port_, SOCK_STREAM | SOCK_NONBLOCK, kConnectTimeout);
+        if (socket_ < 0) {
+            backoff_ = std::clamp(backoff_ * 2, kMinBackoff, kMaxBackoff);
+            retry_ = now + backoff_;
+            return backoff_;
+        }
+        backoff_ = std::chrono::milliseconds{0};
+        offset_ = 0;
+    }
+
+    std::array<iovec, kBatchSize> pieces{};
+    while (!records.empty()) {
+
+        std::size_t count = std::min(records.size(), kBatchSize);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto skip = (i == 0) ? offset_ : 0;
+            pieces[i].iov_base = records[i].data() + skip;
+            pieces[i].iov_len = records[i].size() - skip;
+        }
+
+        msghdr message{};
+        message.msg_iov = pieces.data();
+        message.msg_iovlen = count;
+        auto sent = sendmsg(socket_, &message, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                // the peer is slow: wait a bit, then let the caller collect new records
+                pollfd writable{socket_, POLLOUT, 0};
+                if (poll(&writable, 1, stopping ? kConnectTimeout : kWriteTimeout) == 1) {
+                    continue;
+                }
+                return std::chrono::milliseconds{0};
+            }
+
+            // connection lost: start over with a new one (and the whole record)
+            Disconnect();
+            retry_ = std::chrono::steady_clock::now() + kMinBackoff;
+            return kMinBackoff;
+        }
+
+        auto done = static_cast<std::size_t>(sent);
+        while (done > 0) {
+            auto left = records.front().size() - offset_;
+            if (done < left) {
+                offset_ += done;
+                break;
+            }
+            done -= left;
+            records.pop_front();
+            offset_ = 0;
+        }
+    }
+
+    return std::chrono::milliseconds{0};
+}
@@ -0,0 +1,189 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_TCP_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_TCP_SINK_HPP
+
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include "queue_sink.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which streams event messages over a TCP connection.
+ *
+ * Messages are queued and written by a thread of the sink over a persistent non-blocking
+ * connection. While the peer is slow or unreachable messages stay queued up to a byte budget;
+ * beyond that new messages are dropped and counted (see QueueSink::GetDropped()). A lost
+ * connection is established again with exponential backoff (100 ms up to 10 s), all on the
+ * sink's thread: logging threads never wait for the network.
+ *
+ * URL: "tcp://HOST:PORT"
+ *
+ * URL query parameters:
+ *      framing=line        records end with a newline (added if missing, this is the default)
+ *      framing=length      records are prefixed with their size (4 bytes, big endian)
+ *      queue=BYTES         byte budget of the queue (default 4 MiB)
+ *      priority=LEVEL      events of this level or above take the fast lane (default silent: off, see QueueSink)
+ *
+ * A record cut off by a broken connection is sent again as a whole after reconnecting.
+ * On a crash the records left are sent over the current connection (if any).
+ *
+ * With "gelf+tcp://HOST:PORT" events are sent as GELF messages to a Graylog server (see
+ * GELFFormatter), each terminated by a null byte as GELF TCP inputs expect.
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("tcp://collector:5170?framing=length");
+ *      headcode::logger::Logger::GetLogger()->AddSink(sink);
+ * @endcode
+ */
+class TCPSink : public QueueSink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<TCPSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<TCPSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "TCPSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return (parsed_url.GetScheme() == "tcp") || (parsed_url.GetScheme() == "gelf+tcp");
+        }
+    };
+
+    /**
+     * @brief   How records are delimited in the stream.
+     */
+    enum class Framing {
+        kLine,          //!< @brief Newline terminated.
+        kLength,        //!< @brief 4 byte big endian size prefix.
+        kNull           //!< @brief Null byte terminated (GELF).
+    };
+
+    std::string host_;                                  //!< @brief The host to connect to.
+    std::string port_;                                  //!< @brief The port to connect to.
+    Framing framing_{Framing::kLine};                   //!< @brief How records are delimited.
+    int socket_{-1};                                    //!< @brief The connection; -1 if not connected.
+    std::size_t offset_{0};                             //!< @brief Bytes of the front record already sent.
+    std::chrono::milliseconds backoff_{0};              //!< @brief Current reconnect delay.
+    std::chrono::steady_clock::time_point retry_;       //!< @brief Earliest time for the next connect.
+
+public:
+    /**
+     * @brief   Constructs a sink which streams the log messages over TCP.
+     * @param   tcp_url         URL of the destination.
+     */
+    explicit TCPSink(std::string tcp_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~TCPSink() override;
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Sends the records left over the current connection on a crash.
+     * @param   pending         records taken by the consumer (oldest first); nullptr if busy.
+     * @param   queued          records queued after these; nullptr if busy.
+     */
+    void CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) override;
+
+    /**
+     * @brief   Closes the connection.
+     */
+    void Disconnect();
+
+    /**
+     * @brief   Adds the newline or the length prefix.
+     * @param   record          the record to frame.
+     */
+    void Frame_(std::string & record) const override;
+
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   Writes the records to the connection, connecting first if needed.
+     * @param   records         the records to send, oldest first.
+     * @param   stopping        the sink is about to be destroyed.
+     * @return  Time to wait before records left are tried again.
+     */
+    std::chrono::milliseconds Send_(std::deque<std::string> & records, bool stopping) override;
+};
+
+
+}
+
+
+#endif
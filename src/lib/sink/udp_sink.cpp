@@ -0,0 +1,298 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "udp_sink.hpp"
+#include "net.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/logger/formatter.hpp>
+
+#include <headcode/url/url.hpp>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <random>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All UDPSinks storage.
+ */
+std::map<std::string, std::shared_ptr<UDPSink>> UDPSink::Producer::sinks;
+
+
+/**
+ * @brief   All UDPSinks access synchronization mutex.
+ */
+std::mutex UDPSink::Producer::mutex;
+
+
+/**
+ * @brief   Largest payload of an UDP datagram over IPv4.
+ */
+static constexpr std::size_t kMaxDatagramSize = 65507;
+
+
+/**
+ * @brief   Size of the header of a GELF chunk.
+ */
+static constexpr std::size_t kGELFChunkHeaderSize = 12;
+
+
+/**
+ * @brief   Maximum number of chunks of a GELF message.
+ */
+static constexpr std::size_t kGELFMaxChunks = 128;
+
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief   Compresses data with zlib.
+ * @param   data        the data to compress.
+ * @param   gzip        create gzip instead of zlib format.
+ * @return  The compressed data (empty on failure).
+ */
+static std::string Compress(std::string const & data, bool gzip) {
+
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? 31 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+
+    std::string compressed(deflateBound(&stream, data.size()) + 32, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    auto result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return (result == Z_STREAM_END) ? compressed : std::string{};
+}
+#endif
+
+
+UDPSink::UDPSink(std::string udp_url) : QueueSink{udp_url, kDefaultMaxBytes} {
+
+    URL url{udp_url};
+    gelf_ = url.GetScheme() == "gelf+udp";
+    if (url.IsValid() && ((url.GetScheme() == "udp") || gelf_) && !url.GetPort().empty()) {
+        auto host = std::string{url.GetHost()};
+        auto port = std::string{url.GetPort()};
+        destination_ = host + ":" + port;
+        socket_ = ConnectSocket(host, port, SOCK_DGRAM);
+
+        auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+        datagram_size_ = std::clamp<std::size_t>(
+                GetURLQuerySize(parameters, "datagram", kDefaultDatagramSize), 1, kMaxDatagramSize);
+        SetMaxBytes(GetURLQuerySize(parameters, "queue", kDefaultMaxBytes));
+        SetPriority(GetURLQueryLevel(parameters, "priority", static_cast<int>(Level::kSilent)));
+
+        if (gelf_) {
+            SetFormatter(std::make_unique<GELFFormatter>());
+            chunk_size_ = std::clamp<std::size_t>(GetURLQuerySize(parameters, "chunk", kDefaultChunkSize),
+                                                  kGELFChunkHeaderSize + 1,
+                                                  kMaxDatagramSize);
+            auto compress = parameters.find("compress");
+            if (compress != parameters.end()) {
+                compression_ = (compress->second == "gzip")   ? Compression::kGzip
+                               : (compress->second == "zlib") ? Compression::kZlib
+                                                              : Compression::kNone;
+            }
+            message_id_ = (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+        }
+    }
+
+    Start();
+}
+
+
+UDPSink::~UDPSink() {
+    Stop();
+    if (socket_ >= 0) {
+        close(socket_);
+    }
+}
+
+
+void UDPSink::CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) {
+
+    if (socket_ < 0) {
+        return;
+    }
+
+    for (auto records : {pending, queued}) {
+        if (records == nullptr) {
+            continue;
+        }
+        for (auto const & record : *records) {
+            if (gelf_) {
+                if ((record.size() <= chunk_size_) && !signal_safe::Send(socket_, record.data(), record.size())) {
+                    return;
+                }
+                continue;
+            }
+            for (std::size_t offset = 0; offset < record.size(); offset += datagram_size_) {
+                auto size = std::min(datagram_size_, record.size() - offset);
+                if (!signal_safe::Send(socket_, record.data() + offset, size)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+
+void UDPSink::AddGELFDatagrams(std::string const & message, std::deque<std::string> & datagrams) {
+
+    auto const * payload = &message;
+#ifdef HAVE_ZLIB
+    std::string compressed;
+    if (compression_ != Compression::kNone) {
+        compressed = Compress(message, compression_ == Compression::kGzip);
+        if (!compressed.empty()) {
+            payload = &compressed;
+        }
+    }
+#endif
+
+    if (payload->size() <= chunk_size_) {
+        datagrams.push_back(*payload);
+        return;
+    }
+
+    auto chunk_data_size = chunk_size_ - kGELFChunkHeaderSize;
+    auto count = (payload->size() + chunk_data_size - 1) / chunk_data_size;
+    if (count > kGELFMaxChunks) {
+        AddDropped(1);
+        return;
+    }
+
+    // chunk header: magic bytes, message id, sequence number, sequence count
+    auto id = message_id_++;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string chunk;
+        chunk.reserve(chunk_size_);
+        chunk.push_back('\x1e');
+        chunk.push_back('\x0f');
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            chunk.push_back(static_cast<char>(id >> shift));
+        }
+        chunk.push_back(static_cast<char>(i));
+        chunk.push_back(static_cast<char>(count));
+        chunk.append(*payload, i * chunk_data_size, chunk_data_size);
+        datagrams.push_back(std::move(chunk));
+    }
+}
+
+
+std::string UDPSink::GetDescription_() const {
+    return std::string{"UDPSink to "} + destination_;
+}
+
+
+void UDPSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<UDPSink::Producer>());
+    }
+}
+
+
+std::chrono::milliseconds UDPSink::Send_(std::deque<std::string> & records, bool) {
+
+    if (socket_ < 0) {
+        AddDropped(records.size());
+        records.clear();
+        return std::chrono::milliseconds{0};
+    }
+
+    if (gelf_) {
+        std::deque<std::string> datagrams;
+        for (auto const & record : records) {
+            AddGELFDatagrams(record, datagrams);
+        }
+        records.clear();
+        SendDatagrams(datagrams, kMaxDatagramSize);
+        return std::chrono::milliseconds{0};
+    }
+
+    SendDatagrams(records, datagram_size_);
+    return std::chrono::milliseconds{0};
+}
+
+
+void UDPSink::SendDatagrams(std::deque<std::string> & records, std::size_t datagram_size) {
+
+    std::array<iovec, kBatchSize> pieces{};
+    std::array<mmsghdr, kBatchSize> messages{};
+    std::size_t offset = 0;        // bytes of the front record already sent
+
+    while (!records.empty()) {
+
+        // cut the records into datagrams
+        std::size_t count = 0;
+        std::size_t index = 0;
+        std::size_t position = offset;
+        while ((count < kBatchSize) && (index < records.size())) {
+            auto & record = records[index];
+            if (position < record.size()) {
+                auto size = std::min(datagram_size, record.size() - position);
+                pieces[count].iov_base = record.data() + position;
+                pieces[count].iov_len = size;
+                messages[count].msg_hdr.msg_iov = &pieces[count];
+                messages[count].msg_hdr.msg_iovlen = 1;
+                ++count;
+                position += size;
+            }
+            if (position >= record.size()) {
+                ++index;
+                position = 0;
+            }
+        }
+        if (count == 0) {
+            records.clear();
+            break;
+        }
+
+        auto sent = sendmmsg(socket_, messages.data(), static_cast<unsigned int>(count), 0);
+        if ((sent < 0) && (errno == EINTR)) {
+            continue;
+        }
+
+        // on errors (e.g. nobody listening) the datagrams of this batch are dropped
+        auto done = (sent < 0) ? count : static_cast<std::size_t>(sent);
+        for (std::size_t i = 0; i < done; ++i) {
+            while (!records.empty() && (offset >= records.front().size())) {
+                records.pop_front();
+                offset = 0;
+            }
+            offset += std::min(datagram_size, records.front().size() - offset);
+            if (offset >= records.front().size()) {
+                if (sent < 0) {
+                    AddDropped(1);
+                }
+                records.pop_front();
+                offset = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,217 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_UDP_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_UDP_SINK_HPP
+
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include "queue_sink.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which sends each event message as UDP datagram(s).
+ *
+ * Messages are queued and sent in batches by a thread of the sink with sendmmsg(2) on a
+ * connected socket: one system call for many datagrams and no route lookup per datagram.
+ * Messages larger than the datagram size are split into several datagrams.
+ *
+ * UDP does not guarantee delivery: datagrams which cannot be sent (e.g. nobody listens)
+ * are dropped and counted (see QueueSink::GetDropped()).
+ *
+ * On a crash the messages left are sent too (GELF messages only if they fit into a single
+ * datagram, uncompressed).
+ *
+ * URL: "udp://HOST:PORT"
+ *
+ * URL query parameters:
+ *      datagram=BYTES      maximum payload of a datagram (default 1472, fits an Ethernet frame)
+ *      queue=BYTES         byte budget of the queue (default 4 MiB)
+ *      priority=LEVEL      events of this level or above take the fast lane (default silent: off, see QueueSink)
+ *
+ * With "gelf+udp://HOST:PORT" events are sent as GELF messages to a Graylog server (see
+ * GELFFormatter). Messages larger than a chunk are sent as GELF chunks (at most 128 chunks).
+ * Compression is done on the sink's thread.
+ *
+ * URL query parameters for GELF:
+ *      chunk=BYTES         maximum size of a datagram (default 8192)
+ *      compress=zlib       compress messages with zlib (needs zlib at build time)
+ *      compress=gzip       compress messages with gzip (needs zlib at build time)
+ *      queue=BYTES         byte budget of the queue (default 4 MiB)
+ *      priority=LEVEL      events of this level or above take the fast lane (default silent: off, see QueueSink)
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("udp://localhost:5140");
+ *      headcode::logger::Logger::GetLogger()->AddSink(sink);
+ * @endcode
+ */
+class UDPSink : public QueueSink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<UDPSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<UDPSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "UDPSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return (parsed_url.GetScheme() == "udp") || (parsed_url.GetScheme() == "gelf+udp");
+        }
+    };
+
+    /**
+     * @brief   Default maximum payload of a datagram.
+     */
+    static constexpr std::size_t kDefaultDatagramSize = 1472;
+
+    /**
+     * @brief   Maximum number of datagrams passed to a single sendmmsg(2) call.
+     */
+    static constexpr std::size_t kBatchSize = 64;
+
+    /**
+     * @brief   Default maximum size of a GELF chunk.
+     */
+    static constexpr std::size_t kDefaultChunkSize = 8192;
+
+    /**
+     * @brief   Compression of GELF messages.
+     */
+    enum class Compression {
+        kNone,          //!< @brief Not compressed.
+        kZlib,          //!< @brief zlib.
+        kGzip           //!< @brief gzip.
+    };
+
+    std::string destination_;                           //!< @brief "host:port" as given.
+    std::size_t datagram_size_{kDefaultDatagramSize};   //!< @brief Maximum payload of a datagram.
+    int socket_{-1};                                    //!< @brief The connected socket.
+    bool gelf_{false};                                  //!< @brief Send GELF messages.
+    std::size_t chunk_size_{kDefaultChunkSize};         //!< @brief Maximum size of a GELF datagram.
+    Compression compression_{Compression::kNone};       //!< @brief Compression of GELF messages.
+    std::uint64_t message_id_{0};                       //!< @brief Id of the next chunked GELF message.
+
+public:
+    /**
+     * @brief   Constructs a sink which sends the log messages via UDP.
+     * @param   udp_url         URL of the destination.
+     */
+    explicit UDPSink(std::string udp_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~UDPSink() override;
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Sends the records left on a crash.
+     * @param   pending         records taken by the consumer (oldest first); nullptr if busy.
+     * @param   queued          records queued after these; nullptr if busy.
+     */
+    void CrashSend_(std::deque<std::string> const * pending, std::deque<std::string> const * queued) override;
+
+    /**
+     * @brief   Turns a GELF message into datagrams: compressed and chunked as needed.
+     * @param   message         the GELF message.
+     * @param   datagrams       the datagrams to append to.
+     */
+    void AddGELFDatagrams(std::string const & message, std::deque<std::string> & datagrams);
+
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   Sends the records as datagrams.
+     * @param   records         the records to send, oldest first.
+     * @param   stopping        the sink is about to be destroyed.
+     * @return  Always 0: records are sent or dropped.
+     */
+    std::chrono::milliseconds Send_(std::deque<std::string> & records, bool stopping) override;
+
+    /**
+     * @brief   Sends the records as datagrams in batches.
+     * @param   records         the records to send, oldest first.
+     * @param   datagram_size   maximum payload of a datagram; larger records are split.
+     */
+    void SendDatagrams(std::deque<std::string> & records, std::size_t datagram_size);
+};
+
+
+}
+
+
+#endif
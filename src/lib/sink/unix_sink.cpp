@@ -0,0 +1,358 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "unix_sink.hpp"
+#include "../crash_registry.hpp"
+#include "../signal_safe.hpp"
+#include "../url_query.hpp"
+
+#include <headcode/url/url.hpp>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+using namespace headcode::logger;
+using namespace headcode::url;
+
+
+/**
+ * @brief   All UnixSinks storage.
+ */
+std::map<std::string, std::shared_ptr<UnixSink>> UnixSink::Producer::sinks;
+
+
+/**
+ * @brief   All UnixSinks access synchronization mutex.
+ */
+std::mutex UnixSink::Producer::mutex;
+
+
+/**
+ * @brief   Default size of the overflow buffer.
+ */
+static constexpr std::size_t kDefaultOverflowSize = 4 * 1024 * 1024;
+
+
+/**
+ * @brief   Delay before connecting again.
+ */
+static constexpr std::chrono::seconds kRetryDelay{1};
+
+
+/**
+ * @brief   Milliseconds Dump() waits for a full socket.
+ */
+static constexpr int kDumpTimeout = 1000;
+
+
+/**
+ * @brief   Maximum number of records passed to a single system call.
+ */
+static constexpr std::size_t kBatchSize = 64;
+
+
+/**
+ * @brief   Holds a spin lock guarding against the crash handler (which never releases it).
+ */
+class CrashGuard {
+
+    std::atomic_flag & lock_;       //!< @brief The spin lock held.
+
+public:
+    /**
+     * @brief   Constructor: takes the spin lock.
+     * @param   lock        the spin lock.
+     */
+    explicit CrashGuard(std::atomic_flag & lock) : lock_{lock} {
+        while (lock_.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+
+    /**
+     * @brief   Destructor: releases the spin lock.
+     */
+    ~CrashGuard() {
+        lock_.clear(std::memory_order_release);
+    }
+
+    CrashGuard(CrashGuard const &) = delete;
+    CrashGuard & operator=(CrashGuard const &) = delete;
+};
+
+
+UnixSink::UnixSink(std::string unix_url) : Sink{unix_url}, overflow_max_{kDefaultOverflowSize} {
+
+    URL url{unix_url};
+    if (!url.IsValid() || (url.GetScheme() != "unix")) {
+        return;
+    }
+
+    path_ = std::string{url.GetPath()};
+    auto parameters = ParseURLQuery(std::string{url.GetQuery()});
+    auto type = parameters.find("type");
+    seqpacket_ = (type != parameters.end()) && (type->second == "seqpacket");
+    auto mode = parameters.find("mode");
+    nonblocking_ = (mode != parameters.end()) && (mode->second == "nonblocking");
+    overflow_max_ = GetURLQuerySize(parameters, "overflow", kDefaultOverflowSize);
+    if (nonblocking_) {
+        RegisterCrashFlusher(&UnixSink::CrashFlush, this);
+    }
+}
+
+
+UnixSink::~UnixSink() {
+    UnregisterCrashFlusher(this);
+    Dump_();
+    Disconnect();
+}
+
+
+bool UnixSink::Connect() {
+
+    if (socket_ >= 0) {
+        return true;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (path_.empty() || (now < retry_)) {
+        return false;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+
+    auto type = (seqpacket_ ? SOCK_SEQPACKET : SOCK_STREAM) | SOCK_CLOEXEC | (nonblocking_ ? SOCK_NONBLOCK : 0);
+    socket_ = socket(AF_UNIX, type, 0);
+    if ((socket_ >= 0) && (connect(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)) {
+        close(socket_);
+        socket_ = -1;
+    }
+    if (socket_ < 0) {
+        retry_ = now + kRetryDelay;
+        return false;
+    }
+
+    return true;
+}
+
+
+void UnixSink::CrashFlush(void * context) {
+
+    // another thread in the middle of writing would garble the stream
+    auto sink = static_cast<UnixSink *>(context);
+    if (!signal_safe::TryLock(sink->crash_guard_) || (sink->socket_ < 0)) {
+        return;
+    }
+
+    auto offset = sink->offset_;
+    for (auto const & record : sink->overflow_) {
+        if (!signal_safe::Send(sink->socket_, record.data() + offset, record.size() - offset)) {
+            return;
+        }
+        offset = 0;
+    }
+}
+
+
+void UnixSink::Disconnect() {
+    if (socket_ >= 0) {
+        close(socket_);
+        socket_ = -1;
+        retry_ = std::chrono::steady_clock::now() + kRetryDelay;
+    }
+    offset_ = 0;
+}
+
+
+void UnixSink::Dump_() {
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+    CrashGuard guard{crash_guard_};
+    while (!overflow_.empty() && Connect() && !WriteOverflow() && (socket_ >= 0)) {
+        pollfd writable{socket_, POLLOUT, 0};
+        if (poll(&writable, 1, kDumpTimeout) != 1) {
+            break;
+        }
+    }
+}
+
+
+bool UnixSink::Flush_(std::chrono::steady_clock::time_point deadline) {
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+    CrashGuard guard{crash_guard_};
+    while (!overflow_.empty() && Connect() && !WriteOverflow() && (socket_ >= 0)) {
+        auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd writable{socket_, POLLOUT, 0};
+        if ((left.count() <= 0) || (poll(&writable, 1, static_cast<int>(left.count())) != 1)) {
+            break;
+        }
+    }
+    return overflow_.empty();
+}
+
+
+std::string UnixSink::GetDescription_() const {
+    return std::string{"UnixSink to "} + path_;
+}
+
+
+void UnixSink::Keep(std::string const & text, bool newline, std::size_t written) {
+
+    auto size = text.size() + (newline ? 1 : 0);
+
+    // a record partly written to a stream has to be completed, no matter what
+    if (!nonblocking_ || ((written == 0) && (overflow_bytes_ + size > overflow_max_))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    overflow_.push_back(text);
+    if (newline) {
+        overflow_.back().push_back('\n');
+    }
+    overflow_bytes_ += size;
+    if (written > 0) {
+        offset_ = written;
+    }
+}
+
+
+void UnixSink::Log_(Event const & event) {
+
+    auto const & text = Format(event);
+    bool newline = !seqpacket_ && (text.empty() || (text.back() != '\n'));
+
+    auto lock = std::unique_lock<std::mutex>{mutex_};
+    CrashGuard guard{crash_guard_};
+
+    // records held back go first
+    if (!Connect() || !WriteOverflow()) {
+        Keep(text, newline, 0);
+        return;
+    }
+
+    static char newline_character = '\n';
+    std::size_t total = text.size() + (newline ? 1 : 0);
+    std::size_t written = 0;
+    while (written < total) {
+
+        std::array<iovec, 2> pieces{};
+        std::size_t count = 0;
+        if (written < text.size()) {
+            pieces[count].iov_base = const_cast<char *>(text.data()) + written;
+            pieces[count].iov_len = text.size() - written;
+            ++count;
+        }
+        if (newline) {
+            pieces[count].iov_base = &newline_character;
+            pieces[count].iov_len = 1;
+            ++count;
+        }
+
+        msghdr message{};
+        message.msg_iov = pieces.data();
+        message.msg_iovlen = count;
+        auto sent = sendmsg(socket_, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                Disconnect();
+                written = 0;
+            }
+            break;
+        }
+        written += static_cast<std::size_t>(sent);
+    }
+
+    if (written < total) {
+        Keep(text, newline, written);
+    }
+}
+
+
+void UnixSink::RegisterProducer() {
+    static std::atomic_flag registered = ATOMIC_FLAG_INIT;
+    if (!registered.test_and_set()) {
+        SinkFactory::Register(std::make_unique<UnixSink::Producer>());
+    }
+}
+
+
+bool UnixSink::WriteOverflow() {
+
+    std::array<iovec, kBatchSize> pieces{};
+    std::array<mmsghdr, kBatchSize> messages{};
+
+    while (!overflow_.empty()) {
+
+        auto count = std::min(overflow_.size(), kBatchSize);
+        for (std::size_t i = 0; i < count; ++i) {
+            auto skip = (i == 0) ? offset_ : 0;
+            pieces[i].iov_base = overflow_[i].data() + skip;
+            pieces[i].iov_len = overflow_[i].size() - skip;
+            messages[i].msg_hdr.msg_iov = &pieces[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // a stream takes all records with one gather write, a seqpacket socket one message per record
+        ssize_t sent;
+        if (seqpacket_) {
+            sent = sendmmsg(socket_, messages.data(), static_cast<unsigned int>(count), MSG_NOSIGNAL);
+        } else {
+            msghdr message{};
+            message.msg_iov = pieces.data();
+            message.msg_iovlen = count;
+            sent = sendmsg(socket_, &message, MSG_NOSIGNAL);
+        }
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                Disconnect();
+            }
+            return false;
+        }
+
+        if (seqpacket_) {
+            for (ssize_t i = 0; i < sent; ++i) {
+                overflow_bytes_ -= overflow_.front().size();
+                overflow_.pop_front();
+            }
+            continue;
+        }
+
+        auto done = static_cast<std::size_t>(sent);
+        while (done > 0) {
+            auto left = overflow_.front().size() - offset_;
+            if (done < left) {
+                offset_ += done;
+                break;
+            }
+            done -= left;
+            overflow_bytes_ -= overflow_.front().size();
+            overflow_.pop_front();
+            offset_ = 0;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,217 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_SINK_UNIX_SINK_HPP
+#define HEADCODE_SPACE_LOGGER_SINK_UNIX_SINK_HPP
+
+#include <headcode/logger/sink.hpp>
+#include <headcode/logger/sink_factory.hpp>
+
+#include <headcode/url/url.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   A sink which writes event messages to a local agent over a unix domain socket.
+ *
+ * The formatted message is written straight from the formatter's buffer with gather I/O
+ * (sendmsg/sendmmsg): no copies on the way. On a stream socket records end with a newline
+ * (added if missing); on a seqpacket socket each record is a message of its own.
+ *
+ * In blocking mode (the default) logging waits for the agent. In non-blocking mode records
+ * the socket does not take right away are kept in an overflow buffer, written in batches
+ * ahead of the next record or on Sink::Dump(). If the overflow buffer is full new records are
+ * dropped. If the agent is gone, the sink connects again at most once a second. On a crash
+ * the overflow buffer is written out over the current connection (if any).
+ *
+ * URL: "unix:/path/to/socket"
+ *
+ * URL query parameters:
+ *      type=stream         a SOCK_STREAM socket (default)
+ *      type=seqpacket      a SOCK_SEQPACKET socket
+ *      mode=nonblocking    do not wait for the agent
+ *      overflow=BYTES      size of the overflow buffer in non-blocking mode (default 4 MiB)
+ *
+ * Example:
+ * @code
+ *      auto sink = headcode::logger::SinkFactory::Create("unix:/run/agent.sock?mode=nonblocking");
+ *      headcode::logger::Logger::GetLogger()->AddSink(sink);
+ * @endcode
+ */
+class UnixSink : public Sink {
+
+    /**
+     * @brief   Sink producer instance.
+     */
+    struct Producer : public SinkFactory::Producer {
+
+        /**
+         * @brief   Currently known sinks.
+         */
+        static std::map<std::string, std::shared_ptr<UnixSink>> sinks;
+
+        /**
+         * @brief   Synchronizes access to sinks member.
+         */
+        static std::mutex mutex;
+
+        /**
+         * @brief   Creates a sink.
+         * This MAY return already created objects.
+         * @param   url         The URL of the sink to create.
+         * @return  A sink instance.
+         */
+        [[nodiscard]] std::shared_ptr<Sink> Create(std::string const & url) override {
+
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            auto iter = sinks.find(parsed_url.GetURL());
+
+            if (iter == sinks.end()) {
+                auto sink = std::make_shared<UnixSink>(parsed_url.GetURL());
+                sinks.emplace(parsed_url.GetURL(), sink);
+                return sink;
+            }
+
+            return iter->second;
+        }
+
+        /**
+         * @brief   Returns a human readable id for the sink producer.
+         * This id is also used to identify the producer within the factory.
+         * @return  A description for the sink producer.
+         */
+        [[nodiscard]] std::string GetId() const override {
+            return "UnixSink Producer";
+        }
+
+        /**
+         * @brief   Checks if this producer is capable to create the object.
+         * @brief   url         The URL to match against.
+         * @return  True, if this producer can create Sinks matching the given URL.
+         */
+        [[nodiscard]] bool Match(std::string const & url) const override {
+            auto parsed_url = headcode::url::URL{url}.Normalize();
+            return parsed_url.GetScheme() == "unix";
+        }
+    };
+
+    std::string path_;                                  //!< @brief Path of the socket.
+    bool seqpacket_{false};                             //!< @brief SOCK_SEQPACKET instead of SOCK_STREAM.
+    bool nonblocking_{false};                           //!< @brief Do not wait for the agent.
+    std::size_t overflow_max_;                          //!< @brief Size of the overflow buffer.
+    std::deque<std::string> overflow_;                  //!< @brief Records not written yet.
+    std::size_t overflow_bytes_{0};                     //!< @brief Bytes in the overflow buffer.
+    std::size_t offset_{0};                             //!< @brief Bytes of the first overflow record written.
+    std::atomic<std::uint64_t> dropped_{0};             //!< @brief Records dropped so far.
+    int socket_{-1};                                    //!< @brief The connection; -1 if not connected.
+    std::chrono::steady_clock::time_point retry_;       //!< @brief Earliest time for the next connect.
+    std::mutex mutex_;                                  //!< @brief Serializes writing.
+    std::atomic_flag crash_guard_ = ATOMIC_FLAG_INIT;   //!< @brief Held while writing (for crashes).
+
+public:
+    /**
+     * @brief   Constructs a sink which writes the log messages to a unix domain socket.
+     * @param   unix_url        URL of the socket.
+     */
+    explicit UnixSink(std::string unix_url);
+
+    /**
+     * @brief   Destructor.
+     */
+    ~UnixSink() override;
+
+    /**
+     * @brief   Gets the number of records dropped (agent gone or overflow buffer full).
+     * @return  The number of dropped records.
+     */
+    [[nodiscard]] std::uint64_t GetDropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Registers a Producer at the Sink Factory.
+     */
+    static void RegisterProducer();
+
+private:
+    /**
+     * @brief   Writes out the overflow buffer on a crash.
+     * @param   context         the sink.
+     */
+    static void CrashFlush(void * context);
+
+    /**
+     * @brief   Connects to the socket, if not connected yet.
+     * @return  true, if connected.
+     */
+    bool Connect();
+
+    /**
+     * @brief   Closes the connection.
+     */
+    void Disconnect();
+
+    /**
+     * @brief   Writes the overflow buffer, waiting for the socket (up to a second whenever it is full).
+     */
+    void Dump_() override;
+
+    /**
+     * @brief   Writes the overflow buffer, waiting for the socket until the deadline.
+     * @param   deadline    the latest time to return.
+     * @return  true, if the overflow buffer is empty.
+     */
+    bool Flush_(std::chrono::steady_clock::time_point deadline) override;
+
+    /**
+     * @brief   Gets the sink description.
+     * @return  A human readable description of this sink.
+     */
+    [[nodiscard]] std::string GetDescription_() const override;
+
+    /**
+     * @brief   Puts a record into the overflow buffer, if there is room.
+     * @param   text        the record.
+     * @param   newline     append a newline.
+     * @param   written     bytes of the record already written.
+     */
+    void Keep(std::string const & text, bool newline, std::size_t written);
+
+    /**
+     * @brief   This does the actual logging.
+     * @param   event       the event to log.
+     */
+    void Log_(Event const & event) override;
+
+    /**
+     * @brief   Writes records of the overflow buffer as long as the socket takes them.
+     * @return  true, if the overflow buffer is empty now.
+     */
+    bool WriteOverflow();
+};
+
+
+}
+
+
+#endif
@@ -10,8 +10,15 @@
 
 #include "sink/console_sink.hpp"
 #include "sink/file_sink.hpp"
+#include "sink/journal_sink.hpp"
 #include "sink/null_sink.hpp"
+#include "sink/otlp_sink.hpp"
+#include "sink/ring_sink.hpp"
+#include "sink/shm_sink.hpp"
 #include "sink/syslog_sink.hpp"
+#include "sink/tcp_sink.hpp"
+#include "sink/udp_sink.hpp"
+#include "sink/unix_sink.hpp"
 
 #include <atomic>
 #include <map>
@@ -148,7 +155,14 @@ void SinkFactory::RegisterDefaultProducers() {
     if (!registered.test_and_set()) {
         ConsoleSink::RegisterProducer();
         FileSink::RegisterProducer();
+        JournalSink::RegisterProducer();
         NullSink::RegisterProducer();
+        OTLPSink::RegisterProducer();
+        RingSink::RegisterProducer();
+        ShmSink::RegisterProducer();
         SyslogSink::RegisterProducer();
+        TCPSink::RegisterProducer();
+        UDPSink::RegisterProducer();
+        UnixSink::RegisterProducer();
     }
 }
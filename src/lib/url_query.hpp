@@ -0,0 +1,159 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_URL_QUERY_HPP
+#define HEADCODE_SPACE_LOGGER_URL_QUERY_HPP
+
+#include <headcode/logger/level.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <string>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Splits the query part of a sink URL into its parameters.
+ *
+ * E.g. "format=binary&templates" gives {"format": "binary", "templates": ""}.
+ * Values are taken as they are (no percent decoding).
+ *
+ * @param   query       the query part of an URL (without the '?').
+ * @return  The parameters by name.
+ */
+inline std::map<std::string, std::string> ParseURLQuery(std::string const & query) {
+
+    std::map<std::string, std::string> res;
+
+    std::string::size_type start = 0;
+    while (start < query.size()) {
+        auto stop = query.find('&', start);
+        if (stop == std::string::npos) {
+            stop = query.size();
+        }
+        auto parameter = query.substr(start, stop - start);
+        if (!parameter.empty()) {
+            auto equal = parameter.find('=');
+            if (equal == std::string::npos) {
+                res[parameter] = std::string{};
+            } else {
+                res[parameter.substr(0, equal)] = parameter.substr(equal + 1);
+            }
+        }
+        start = stop + 1;
+    }
+
+    return res;
+}
+
+
+/**
+ * @brief   Checks if an URL query parameter is turned on.
+ * @param   parameters      the parameters as returned by ParseURLQuery().
+ * @param   name            the name of the parameter.
+ * @return  true, if the parameter is present and neither "0", "false", "no" nor "off".
+ */
+inline bool IsURLQueryFlagSet(std::map<std::string, std::string> const & parameters, std::string const & name) {
+    auto iter = parameters.find(name);
+    if (iter == parameters.end()) {
+        return false;
+    }
+    auto const & value = iter->second;
+    return (value != "0") && (value != "false") && (value != "no") && (value != "off");
+}
+
+
+/**
+ * @brief   Reads a size from the URL query parameters.
+ * @param   parameters      the parameters as returned by ParseURLQuery().
+ * @param   name            the name of the parameter.
+ * @param   value           the default value.
+ * @return  The value of the parameter or the default value if missing or invalid.
+ */
+inline std::size_t GetURLQuerySize(std::map<std::string, std::string> const & parameters,
+                                   std::string const & name,
+                                   std::size_t value) {
+    auto iter = parameters.find(name);
+    if (iter == parameters.end()) {
+        return value;
+    }
+
+    // digits only: stoul() would take "-1" as the largest size and "12abc" as 12
+    auto const & text = iter->second;
+    if (text.empty() || (text.front() < '0') || (text.front() > '9')) {
+        return value;
+    }
+    try {
+        std::size_t pos = 0;
+        auto parsed = std::stoull(text, &pos);
+        if ((pos == text.size()) && (parsed <= std::numeric_limits<std::size_t>::max())) {
+            value = static_cast<std::size_t>(parsed);
+        }
+    } catch (...) {
+    }
+    return value;
+}
+
+
+/**
+ * @brief   Parses a log level given in an URL query: a level name (e.g. "warning") or a number.
+ * @param   text            the text of the level.
+ * @param   level           receives the level value; left alone if the text is invalid.
+ * @return  true, if the text is a valid level.
+ */
+inline bool ParseURLQueryLevel(std::string const & text, int & level) {
+
+    for (auto candidate : {Level::kSilent, Level::kCritical, Level::kWarning, Level::kInfo, Level::kDebug}) {
+        if (text == GetLevelText(candidate)) {
+            level = static_cast<int>(candidate);
+            return true;
+        }
+    }
+
+    try {
+        std::size_t pos = 0;
+        auto parsed = std::stoi(text, &pos);
+        if (pos != text.size()) {
+            return false;
+        }
+        level = parsed;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+
+/**
+ * @brief   Reads a log level from the URL query parameters (see ParseURLQueryLevel()).
+ * @param   parameters      the parameters as returned by ParseURLQuery().
+ * @param   name            the name of the parameter.
+ * @param   value           the default value.
+ * @return  The value of the parameter or the default value if missing or invalid.
+ */
+inline int GetURLQueryLevel(std::map<std::string, std::string> const & parameters,
+                            std::string const & name,
+                            int value) {
+    auto iter = parameters.find(name);
+    if (iter != parameters.end()) {
+        ParseURLQueryLevel(iter->second, value);
+    }
+    return value;
+}
+
+
+}
+
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include "wakeup.hpp"
+#include "worker_thread.hpp"
+
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace headcode::logger;
+
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "the futex word must be 32 bits");
+
+
+/**
+ * @brief   Number of spins between two looks at the clock.
+ */
+static constexpr unsigned int kSpinsPerClockCheck = 64;
+
+
+/**
+ * @brief   Tells the CPU we are spinning (saves power, frees the core for a sibling hyper-thread).
+ */
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+
+void Wakeup::Notify() noexcept {
+    sequence_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_seq_cst)) {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t *>(&sequence_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+}
+
+
+void Wakeup::Wait(std::uint32_t sequence, std::chrono::steady_clock::time_point deadline) noexcept {
+
+    auto const [spin, yield] = GetWorkerBusyWait();
+    auto const start = std::chrono::steady_clock::now();
+    auto const spin_end = (spin.count() > 0) ? std::min(deadline, start + spin) : start;
+    auto const yield_end = (yield.count() > 0) ? std::min(deadline, spin_end + yield) : spin_end;
+
+    // spinning catches records coming in quickly without a context switch on either side
+    if (spin.count() > 0) {
+        for (unsigned int spins = 1; GetSequence() == sequence; ++spins) {
+            if (((spins % kSpinsPerClockCheck) == 0) && (std::chrono::steady_clock::now() >= spin_end)) {
+                break;
+            }
+            CpuRelax();
+        }
+    }
+    while ((GetSequence() == sequence) && (std::chrono::steady_clock::now() < yield_end)) {
+        sched_yield();
+    }
+
+    // announce the sleep before looking again: Notify() then either sees us or the futex sees its bump
+    sleeping_.store(true, std::memory_order_seq_cst);
+    while (sequence_.load(std::memory_order_seq_cst) == sequence) {
+
+        timespec timeout{};
+        timespec * timeout_pointer = nullptr;
+        if (deadline != std::chrono::steady_clock::time_point::max()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                break;
+            }
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+            timeout.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+            timeout.tv_nsec = static_cast<long>(left.count() % 1000000000);
+            timeout_pointer = &timeout;
+        }
+        syscall(SYS_futex,
+                reinterpret_cast<std::uint32_t *>(&sequence_),
+                FUTEX_WAIT_PRIVATE,
+                sequence,
+                timeout_pointer,
+                nullptr,
+                0);
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+}
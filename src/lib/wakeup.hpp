@@ -0,0 +1,63 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_WAKEUP_HPP
+#define HEADCODE_SPACE_LOGGER_WAKEUP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Wakes a single waiting worker: spinning first, then yielding, then sleeping on a futex.
+ *
+ * The waiter takes the sequence number, checks its condition and calls Wait() if not met.
+ * Notify() bumps the sequence number and only enters the kernel if the waiter sleeps: while
+ * it spins or yields (see WorkerSettings) a notification costs a single atomic increment.
+ */
+class Wakeup {
+
+    std::atomic<std::uint32_t> sequence_{0};        //!< @brief Bumped on each notification; the futex word.
+    std::atomic<bool> sleeping_{false};             //!< @brief The waiter sleeps on the futex.
+
+public:
+    /**
+     * @brief   Gets the sequence number to pass to Wait().
+     * Take it before checking the condition waited for.
+     * @return  The current sequence number.
+     */
+    [[nodiscard]] std::uint32_t GetSequence() const noexcept {
+        return sequence_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief   Wakes the waiter.
+     */
+    void Notify() noexcept;
+
+    /**
+     * @brief   Waits for a notification after the sequence number has been taken.
+     * Spurious returns are possible: check the condition again.
+     * @param   sequence    the sequence number taken before checking the condition.
+     * @param   deadline    the latest time to return.
+     */
+    void Wait(std::uint32_t sequence, std::chrono::steady_clock::time_point deadline) noexcept;
+};
+
+
+}
+
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/worker.hpp>
+
+#include "worker_thread.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <list>
+#include <mutex>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   A worker thread running.
+ */
+struct RunningWorker {
+    pthread_t handle;                       //!< @brief The thread.
+    pid_t tid;                              //!< @brief The kernel thread id (for the nice value).
+    std::string kind;                       //!< @brief The kind of the worker.
+};
+
+
+/**
+ * @brief   All workers and their settings.
+ */
+struct WorkerRegistry {
+    std::mutex mutex_;                      //!< @brief Guards all of the below.
+    WorkerSettings settings_;               //!< @brief The current settings.
+    bool set_{false};                       //!< @brief The settings have been set (not the defaults).
+    std::list<RunningWorker> workers_;      //!< @brief The workers running.
+};
+
+
+/**
+ * @brief   Time idle workers spin in microseconds (see WorkerSettings::spin).
+ */
+static std::atomic<std::int64_t> worker_spin{0};
+
+
+/**
+ * @brief   Time idle workers yield in microseconds (see WorkerSettings::yield).
+ */
+static std::atomic<std::int64_t> worker_yield{0};
+
+
+/**
+ * @brief   Gets the worker registry.
+ * Sinks held by static objects stop their workers at exit: the registry is never destroyed.
+ * @return  The worker registry.
+ */
+static WorkerRegistry & GetRegistry() {
+    static auto registry = new WorkerRegistry;
+    return *registry;
+}
+
+
+/**
+ * @brief   Applies worker settings to a thread.
+ * @param   settings    the settings.
+ * @param   worker      the worker.
+ * @param   scheduling  apply affinity, scheduling policy and nice value too, not only the name.
+ * @return  true, if all settings have been applied.
+ */
+static bool Apply(WorkerSettings const & settings, RunningWorker const & worker, bool scheduling) {
+
+    bool applied = true;
+
+    auto name = (settings.name_prefix + worker.kind).substr(0, 15);
+    applied = (pthread_setname_np(worker.handle, name.c_str()) == 0) && applied;
+    if (!scheduling) {
+        return applied;
+    }
+
+    if (!settings.cpus.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (auto cpu : settings.cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        applied = (pthread_setaffinity_np(worker.handle, sizeof(cpus), &cpus) == 0) && applied;
+    }
+
+    sched_param parameter{};
+    parameter.sched_priority = settings.priority;
+    applied = (pthread_setschedparam(worker.handle, settings.policy, &parameter) == 0) && applied;
+
+    // on Linux the nice value belongs to the thread, not to the process
+    applied = (setpriority(PRIO_PROCESS, static_cast<id_t>(worker.tid), settings.nice) == 0) && applied;
+
+    return applied;
+}
+
+
+std::pair<std::chrono::microseconds, std::chrono::microseconds> headcode::logger::GetWorkerBusyWait() noexcept {
+    return {std::chrono::microseconds{worker_spin.load(std::memory_order_relaxed)},
+            std::chrono::microseconds{worker_yield.load(std::memory_order_relaxed)}};
+}
+
+
+std::size_t headcode::logger::GetWorkerCount() {
+    auto & registry = GetRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex_};
+    return registry.workers_.size();
+}
+
+
+WorkerSettings headcode::logger::GetWorkerSettings() {
+    auto & registry = GetRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex_};
+    return registry.settings_;
+}
+
+
+bool headcode::logger::SetWorkerSettings(WorkerSettings settings) {
+
+    auto & registry = GetRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex_};
+    registry.settings_ = std::move(settings);
+    registry.set_ = true;
+    worker_spin.store(std::max<std::int64_t>(registry.settings_.spin.count(), 0), std::memory_order_relaxed);
+    worker_yield.store(std::max<std::int64_t>(registry.settings_.yield.count(), 0), std::memory_order_relaxed);
+
+    bool applied = true;
+    for (auto const & worker : registry.workers_) {
+        applied = Apply(registry.settings_, worker, true) && applied;
+    }
+    return applied;
+}
+
+
+std::thread headcode::logger::StartWorker(std::string kind, std::function<void()> function) {
+
+    // the worker is running with its settings when we return
+    std::promise<void> started;
+    auto started_future = started.get_future();
+    auto run = [kind = std::move(kind), function = std::move(function), started = std::move(started)]() mutable {
+        auto & registry = GetRegistry();
+        std::list<RunningWorker>::iterator self;
+        {
+            // until settings are set, workers run as the thread starting them (only their name is set);
+            // settings failing on a new worker (e.g. missing privileges) are no reason not to work
+            std::lock_guard<std::mutex> lock{registry.mutex_};
+            registry.workers_.push_back(
+                    RunningWorker{pthread_self(), static_cast<pid_t>(syscall(SYS_gettid)), kind});
+            self = std::prev(registry.workers_.end());
+            Apply(registry.settings_, *self, registry.set_);
+        }
+        started.set_value();
+
+        function();
+
+        std::lock_guard<std::mutex> lock{registry.mutex_};
+        registry.workers_.erase(self);
+    };
+    std::thread worker{std::move(run)};
+    started_future.wait();
+
+    return worker;
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#ifndef HEADCODE_SPACE_LOGGER_WORKER_THREAD_HPP
+#define HEADCODE_SPACE_LOGGER_WORKER_THREAD_HPP
+
+#include <headcode/logger/worker.hpp>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+
+
+/**
+ * @brief   The headcode logger namespace
+ */
+namespace headcode::logger {
+
+
+/**
+ * @brief   Gets how long idle workers spin and yield before they sleep (see WorkerSettings).
+ * This takes no lock.
+ * @return  The spin and the yield time.
+ */
+std::pair<std::chrono::microseconds, std::chrono::microseconds> GetWorkerBusyWait() noexcept;
+
+
+/**
+ * @brief   Starts a worker thread running with the current WorkerSettings.
+ * @param   kind        the kind of the worker, part of the thread name (e.g. "udp").
+ * @param   function    the work to do.
+ * @return  The thread.
+ */
+std::thread StartWorker(std::string kind, std::function<void()> function);
+
+
+}
+
+
+#endif
@@ -0,0 +1,391 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+TEST(BinaryFormatter, regular) {
+
+    headcode::logger::BinaryFormatter formatter;
+
+    headcode::logger::Event event1{headcode::logger::Level::kInfo, "foo"};
+    event1 << "The quick brown fox jumps over the lazy dog.";
+    headcode::logger::Event event2{headcode::logger::Level::kDebug, "foo.bar"};
+    event2 << "The quick brown \nfox jumps over \nthe lazy dog.";
+    headcode::logger::Event event3{headcode::logger::Level::kCritical, "foo"};
+    event3 << "Jackdaws love my big sphinx of quartz.";
+
+    std::stringstream ss;
+    ss << formatter.Format(event1) << formatter.Format(event2) << formatter.Format(event3);
+
+    // the logger names are written only once: "foo" and "foo.bar"
+    auto binary = ss.str();
+    std::size_t count = 0;
+    for (auto pos = binary.find("foo"); pos != std::string::npos; pos = binary.find("foo", pos + 1)) {
+        ++count;
+    }
+    EXPECT_EQ(count, 2u);
+
+    headcode::logger::BinaryReader reader{ss};
+    headcode::logger::BinaryRecord record;
+    for (auto event : {&event1, &event2, &event3}) {
+        ASSERT_TRUE(reader.Next(record));
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(event->GetTimePoint().time_since_epoch());
+        EXPECT_EQ(std::chrono::duration_cast<std::chrono::microseconds>(record.time_point.time_since_epoch()), time);
+        EXPECT_EQ(record.level, event->GetLevel());
+        EXPECT_EQ(record.thread_id, event->GetThreadId());
+        EXPECT_EQ(record.logger, event->GetLogger()->GetName());
+        EXPECT_EQ(record.message, event->GetMessage());
+        EXPECT_EQ(headcode::logger::StandardFormatter::Render(
+                          record.time_point, record.level, record.logger, record.message),
+                  headcode::logger::StandardFormatter{}.Format(*event));
+    }
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_FALSE(reader.HasError());
+}
+
+
+TEST(BinaryFormatter, file) {
+
+    auto log_file = std::filesystem::path{"test.hlog"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    // two sessions appended to the very same file
+    for (int session = 0; session < 2; ++session) {
+        auto sink = headcode::logger::SinkFactory::Create("file:test.hlog");
+        sink->SetFormatter(std::make_unique<headcode::logger::BinaryFormatter>());
+        for (int i = 0; i < 10; ++i) {
+            headcode::logger::Event event{headcode::logger::Level::kInfo, "foo.bar"};
+            event << "Session " << session << ", event " << i;
+            sink->Log(event);
+        }
+    }
+
+    std::ifstream in{log_file, std::ios::in | std::ios::binary};
+    headcode::logger::BinaryReader reader{in};
+    headcode::logger::BinaryRecord record;
+    for (int session = 0; session < 2; ++session) {
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(reader.Next(record));
+            EXPECT_EQ(record.logger, "foo.bar");
+            EXPECT_EQ(record.message, "Session " + std::to_string(session) + ", event " + std::to_string(i));
+        }
+    }
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_FALSE(reader.HasError());
+}
+
+
+TEST(BinaryReader, malformed) {
+
+    std::stringstream ss{"This is not a binary log at all."};
+    headcode::logger::BinaryReader reader{ss};
+    headcode::logger::BinaryRecord record;
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_TRUE(reader.HasError());
+}
+
+
+TEST(BinaryReader, index) {
+
+    headcode::logger::BinaryFormatter formatter{256};
+
+    std::stringstream ss;
+    for (int i = 0; i < 100; ++i) {
+        headcode::logger::Event event{i % 10 == 0 ? headcode::logger::Level::kWarning : headcode::logger::Level::kDebug,
+                                      i < 50 ? "foo" : "bar"};
+        event << "Event " << i << ": the quick brown fox jumps over the lazy dog.";
+        ss << formatter.Format(event);
+    }
+
+    auto blocks = headcode::logger::BinaryReader::LoadIndex(ss);
+    ASSERT_GT(blocks.size(), 2u);
+    EXPECT_EQ(blocks.front().offset, 0u);
+    EXPECT_FALSE(blocks.front().session);
+
+    // blocks cover the whole stream in order and count all events
+    std::uint64_t offset = 0;
+    std::uint64_t events = 0;
+    for (auto const & block : blocks) {
+        EXPECT_EQ(block.offset, offset);
+        offset += block.size;
+        if (block.indexed) {
+            events += block.events;
+            EXPECT_LE(block.first, block.last);
+            EXPECT_GE(block.min_level, static_cast<int>(headcode::logger::Level::kWarning));
+            EXPECT_LE(block.max_level, static_cast<int>(headcode::logger::Level::kDebug));
+            EXPECT_FALSE(block.loggers.empty());
+        }
+    }
+    EXPECT_EQ(offset, ss.str().size());
+
+    // each block decodes on its own
+    headcode::logger::BinaryReader reader{ss};
+    headcode::logger::BinaryRecord record;
+    std::uint64_t read = 0;
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+        reader.Seek(*it);
+        std::uint64_t block_events = 0;
+        while (reader.Next(record)) {
+            EXPECT_TRUE(record.logger == "foo" || record.logger == "bar");
+            if (it->indexed) {
+                EXPECT_GE(record.time_point, it->first);
+                EXPECT_LE(record.time_point, it->last);
+            }
+            ++block_events;
+        }
+        EXPECT_FALSE(reader.HasError());
+        if (it->indexed) {
+            EXPECT_EQ(block_events, it->events);
+        }
+        read += block_events;
+    }
+    EXPECT_EQ(read, 100u);
+
+    // reading sequentially skips the index records
+    ss.clear();
+    ss.seekg(0);
+    headcode::logger::BinaryReader sequential{ss};
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(sequential.Next(record));
+        EXPECT_EQ(record.logger, i < 50 ? "foo" : "bar");
+        EXPECT_EQ(record.message.rfind("Event " + std::to_string(i) + ":", 0), 0u);
+    }
+    EXPECT_FALSE(sequential.Next(record));
+    EXPECT_FALSE(sequential.HasError());
+
+    // a torn write at the end leaves the indexed blocks intact
+    auto binary = ss.str();
+    std::stringstream truncated{binary.substr(0, binary.size() - 3)};
+    auto truncated_blocks = headcode::logger::BinaryReader::LoadIndex(truncated);
+    ASSERT_FALSE(truncated_blocks.empty());
+    EXPECT_FALSE(truncated_blocks.back().indexed);
+    EXPECT_EQ(truncated_blocks.back().offset + truncated_blocks.back().size, binary.size() - 3);
+    for (std::size_t i = 0; i + 1 < truncated_blocks.size(); ++i) {
+        EXPECT_TRUE(truncated_blocks[i].indexed);
+    }
+}
+
+
+TEST(BinaryReader, index_sessions) {
+
+    std::stringstream ss;
+
+    // first session stops in the middle of a block, second one is appended
+    for (int session = 0; session < 2; ++session) {
+        headcode::logger::BinaryFormatter formatter{200};
+        for (int i = 0; i < 20; ++i) {
+            headcode::logger::Event event{headcode::logger::Level::kInfo, "foo"};
+            event << "Session " << session << ", event " << i;
+            ss << formatter.Format(event);
+        }
+    }
+
+    auto blocks = headcode::logger::BinaryReader::LoadIndex(ss);
+    std::uint64_t offset = 0;
+    std::size_t unindexed = 0;
+    for (auto const & block : blocks) {
+        EXPECT_EQ(block.offset, offset);
+        offset += block.size;
+        unindexed += block.indexed ? 0 : 1;
+    }
+    EXPECT_EQ(offset, ss.str().size());
+    EXPECT_GE(unindexed, 1u);
+
+    headcode::logger::BinaryReader reader{ss};
+    headcode::logger::BinaryRecord record;
+    std::vector<std::string> messages;
+    for (auto const & block : blocks) {
+        reader.Seek(block);
+        while (reader.Next(record)) {
+            EXPECT_EQ(record.logger, "foo");
+            messages.push_back(record.message);
+        }
+        EXPECT_FALSE(reader.HasError());
+    }
+    ASSERT_EQ(messages.size(), 40u);
+    for (int session = 0; session < 2; ++session) {
+        for (int i = 0; i < 20; ++i) {
+            EXPECT_EQ(messages[session * 20 + i], "Session " + std::to_string(session) + ", event " + std::to_string(i));
+        }
+    }
+}
+
+
+TEST(BinaryReader, index_out_of_order) {
+
+    headcode::logger::BinaryFormatter formatter{200};
+    auto logger = headcode::logger::Logger::GetLogger("foo");
+    auto now = std::chrono::system_clock::now();
+
+    // replayed events go back in time: the blocks still cover all of their events
+    std::stringstream ss;
+    for (int i = 0; i < 40; ++i) {
+        auto time_point = now + std::chrono::seconds{(i % 2 == 0) ? i : -i};
+        headcode::logger::Event event{
+                time_point, static_cast<int>(headcode::logger::Level::kInfo), logger, 1, "Event " + std::to_string(i)};
+        ss << formatter.Format(event);
+    }
+
+    auto blocks = headcode::logger::BinaryReader::LoadIndex(ss);
+    ASSERT_GT(blocks.size(), 2u);
+
+    headcode::logger::BinaryReader reader{ss};
+    headcode::logger::BinaryRecord record;
+    std::size_t read = 0;
+    for (auto const & block : blocks) {
+        reader.Seek(block);
+        auto first = std::chrono::system_clock::time_point::max();
+        auto last = std::chrono::system_clock::time_point::min();
+        while (reader.Next(record)) {
+            EXPECT_EQ(record.message, "Event " + std::to_string(read));
+            first = std::min(first, record.time_point);
+            last = std::max(last, record.time_point);
+            ++read;
+        }
+        EXPECT_FALSE(reader.HasError());
+        if (block.indexed) {
+            EXPECT_EQ(block.first, first);
+            EXPECT_EQ(block.last, last);
+            EXPECT_LT(block.first, block.last);
+        }
+    }
+    EXPECT_EQ(read, 40u);
+}
+
+
+TEST(BinaryFormatter, templates) {
+
+    std::vector<std::string> messages{"request done in 42 us",
+                                      "request done in 4711 us",
+                                      "request done in 0 us",
+                                      "no numbers at all",
+                                      "leading zeros: 007, 0000",
+                                      "huge: 123456789012345678901234567890",
+                                      "-17 degrees at 23:59:59.999",
+                                      std::string{"binary \0 zero 1", 15},
+                                      "",
+                                      "request done in 42 us"};
+
+    headcode::logger::BinaryFormatter plain_formatter;
+    headcode::logger::BinaryFormatter template_formatter{headcode::logger::BinaryFormatter::kDefaultIndexBlockSize,
+                                                         true};
+
+    std::stringstream plain;
+    std::stringstream templated;
+    for (int i = 0; i < 100; ++i) {
+        for (auto const & message : messages) {
+            headcode::logger::Event event{headcode::logger::Level::kInfo, "foo"};
+            event << message;
+            plain << plain_formatter.Format(event);
+            templated << template_formatter.Format(event);
+        }
+    }
+    EXPECT_LT(templated.str().size(), plain.str().size());
+
+    headcode::logger::BinaryReader reader{templated};
+    headcode::logger::BinaryRecord record;
+    for (int i = 0; i < 100; ++i) {
+        for (auto const & message : messages) {
+            ASSERT_TRUE(reader.Next(record));
+            EXPECT_EQ(record.logger, "foo");
+            EXPECT_EQ(record.message, message);
+        }
+    }
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_FALSE(reader.HasError());
+}
+
+
+TEST(BinaryFormatter, templates_url) {
+
+    auto log_file = std::filesystem::path{"test_templates.hlog"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    auto sink = headcode::logger::SinkFactory::Create("file:test_templates.hlog?format=binary&templates=true");
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo, "foo"};
+        event << "request " << i << " done in " << i * 100 << " us";
+        sink->Log(event);
+    }
+
+    std::ifstream in{log_file, std::ios::in | std::ios::binary};
+    headcode::logger::BinaryReader reader{in};
+    headcode::logger::BinaryRecord record;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(reader.Next(record));
+        EXPECT_EQ(record.message, "request " + std::to_string(i) + " done in " + std::to_string(i * 100) + " us");
+    }
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_FALSE(reader.HasError());
+}
+
+
+TEST(BinaryFormatter, threads) {
+
+    // records are encoded in the order they are written, whatever the threads do
+    int run = 0;
+    for (auto const & query : {"", "&templates=true", "&combine=true", "&buffer=65536", "&sync=periodic"}) {
+
+        auto log_file = std::filesystem::path{"test_threads_" + std::to_string(run++) + ".hlog"};
+        if (std::filesystem::exists(log_file)) {
+            std::filesystem::remove(log_file);
+        }
+        auto sink = headcode::logger::SinkFactory::Create("file:" + log_file.string() + "?format=binary" + query);
+
+        int const thread_count = 16;
+        int const event_count = 2000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < event_count; ++i) {
+                    headcode::logger::Event event{headcode::logger::Level::kInfo, "thread." + std::to_string(t)};
+                    event << "thread " << t << " event " << i;
+                    sink->Log(event);
+                }
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        sink->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{5});
+
+        std::ifstream in{log_file, std::ios::in | std::ios::binary};
+        headcode::logger::BinaryReader reader{in};
+        headcode::logger::BinaryRecord record;
+        std::vector<int> next(thread_count, 0);
+        int records = 0;
+        while (reader.Next(record)) {
+            int t = -1;
+            int i = -1;
+            ASSERT_EQ(std::sscanf(record.message.c_str(), "thread %d event %d", &t, &i), 2) << query;
+            ASSERT_GE(t, 0);
+            ASSERT_LT(t, thread_count);
+            EXPECT_EQ(record.logger, "thread." + std::to_string(t)) << query;
+            EXPECT_EQ(i, next[t]++) << query;
+            ++records;
+        }
+        EXPECT_FALSE(reader.HasError()) << query;
+        EXPECT_EQ(records, thread_count * event_count) << query;
+    }
+}
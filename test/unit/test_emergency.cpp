@@ -0,0 +1,99 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <climits>
+#include <csignal>
+#include <string>
+
+
+/**
+ * @brief   Reads all bytes waiting in a pipe.
+ * @param   fd          the read end of the pipe (non-blocking).
+ * @return  The bytes read.
+ */
+static std::string ReadPipe(int fd) {
+    std::string res;
+    char buffer[4096];
+    for (auto size = read(fd, buffer, sizeof(buffer)); size > 0; size = read(fd, buffer, sizeof(buffer))) {
+        res.append(buffer, static_cast<std::size_t>(size));
+    }
+    return res;
+}
+
+
+TEST(Emergency, regular) {
+
+    int fds[2];
+    ASSERT_EQ(pipe2(fds, O_NONBLOCK), 0);
+    ASSERT_TRUE(headcode::logger::AddEmergencyDescriptor(fds[1]));
+    headcode::logger::RemoveEmergencyDescriptor(2);
+
+    {
+        headcode::logger::Emergency emergency{"oom"};
+        emergency << "wanted " << 4096u << " bytes, " << -12 << ' ' << true << ' ' << LLONG_MIN;
+        EXPECT_EQ(emergency.GetMessage(), "wanted 4096 bytes, -12 true -9223372036854775808");
+    }
+    headcode::logger::Emergency{} << "first\nsecond";
+
+    headcode::logger::AddEmergencyDescriptor(2);
+    headcode::logger::RemoveEmergencyDescriptor(fds[1]);
+    headcode::logger::Emergency{} << "not in the pipe";
+
+    auto text = ReadPipe(fds[0]);
+    auto first = text.find('\n');
+    ASSERT_NE(first, std::string::npos);
+    auto line = text.substr(0, first);
+    EXPECT_EQ(line.size(),
+              std::string{"[2021-04-08T10:15:02,123+00:00] (critical) {oom}: wanted 4096 bytes, -12 true "
+                          "-9223372036854775808"}
+                      .size());
+    EXPECT_NE(line.find("] (critical) {oom}: wanted 4096 bytes,"), std::string::npos);
+    EXPECT_NE(text.find("] (critical): first\n"), std::string::npos);
+    EXPECT_NE(text.find("] (critical): second\n"), std::string::npos);
+    EXPECT_EQ(text.find("not in the pipe"), std::string::npos);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+
+TEST(Emergency, capacity) {
+
+    headcode::logger::RemoveEmergencyDescriptor(2);
+    {
+        headcode::logger::Emergency emergency;
+        emergency << std::string(2000, 'x').c_str() << static_cast<char const *>(nullptr);
+        EXPECT_EQ(emergency.GetMessage().size(), headcode::logger::Emergency::kCapacity);
+    }
+    headcode::logger::AddEmergencyDescriptor(2);
+}
+
+
+/**
+ * @brief   Logs an emergency message from a signal handler.
+ */
+static void OnSignal(int signal_number) {
+    headcode::logger::Emergency{"signal"} << "caught signal " << signal_number;
+    _exit(3);
+}
+
+
+TEST(Emergency, signal_handler) {
+    auto logging = []() {
+        std::signal(SIGUSR1, OnSignal);
+        std::raise(SIGUSR1);
+    };
+    EXPECT_EXIT(logging(), testing::ExitedWithCode(3), R"(\(critical\) \{signal\}: caught signal [0-9]+)");
+}
@@ -164,3 +164,48 @@ TEST(Event, critical) {
         EXPECT_EQ(critical.GetLevel(), static_cast<int>(headcode::logger::Level::kCritical));
     }
 }
+
+
+TEST(Event, replay) {
+
+    auto logger = headcode::logger::Logger::GetLogger("replay");
+    auto logged = logger->GetEventsLogged();
+    auto time_point = std::chrono::system_clock::now() - std::chrono::hours{1};
+
+    {
+        headcode::logger::Event event{
+                time_point, static_cast<int>(headcode::logger::Level::kWarning), logger, 4711, "Replayed."};
+        EXPECT_EQ(event.GetTimePoint(), time_point);
+        EXPECT_EQ(event.GetLevel(), static_cast<int>(headcode::logger::Level::kWarning));
+        EXPECT_EQ(event.GetLogger(), logger);
+        EXPECT_EQ(event.GetThreadId(), 4711u);
+        EXPECT_EQ(event.GetMessage(), "Replayed.");
+    }
+
+    // replayed events are not handed to the logger again
+    EXPECT_EQ(logger->GetEventsLogged(), logged);
+}
+
+
+TEST(Event, sequence) {
+    headcode::logger::Event first{headcode::logger::Level::kSilent};
+    headcode::logger::Event second{headcode::logger::Level::kSilent};
+    EXPECT_GT(first.GetSequence(), 0u);
+    EXPECT_GT(second.GetSequence(), first.GetSequence());
+
+    // numbered when asked for first, then kept
+    headcode::logger::Event third{headcode::logger::Level::kSilent};
+    headcode::logger::Event fourth{headcode::logger::Level::kSilent};
+    auto sequence = fourth.GetSequence();
+    EXPECT_GT(third.GetSequence(), sequence);
+    EXPECT_EQ(fourth.GetSequence(), sequence);
+}
+
+
+TEST(Event, message_view) {
+    headcode::logger::Event event{headcode::logger::Level::kSilent};
+    EXPECT_TRUE(event.GetMessageView().empty());
+    event << "The answer is " << 42 << ".";
+    EXPECT_EQ(event.GetMessageView(), "The answer is 42.");
+    EXPECT_EQ(event.GetMessageView(), event.GetMessage());
+}
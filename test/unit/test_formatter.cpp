@@ -10,6 +10,12 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
 
 TEST(Formatter, message_split) {
 
@@ -129,3 +135,172 @@ TEST(StandardFormatter, regular) {
     EXPECT_FALSE(log.empty());
     std::cerr << log;
 }
+
+
+TEST(ColorDarkBackgroundFormatter, regular) {
+
+    // Without the terminal color codes, we ought to get the very same as the StandardFormatter.
+    auto strip_colors = [](std::string const & s) {
+        static std::regex const re{"\x1B\\[[0-9;]*m"};
+        return std::regex_replace(s, re, "");
+    };
+
+    for (auto level : {1, 2, 3, 4, 1000}) {
+
+        headcode::logger::Event event1{level};
+        event1 << "The quick brown fox jumps over the lazy dog.";
+        auto log = headcode::logger::ColorDarkBackgroundFormatter{}.Format(event1);
+        EXPECT_EQ(log.rfind("\x1B[0m"), log.size() - 4);
+        EXPECT_EQ(strip_colors(log), headcode::logger::StandardFormatter{}.Format(event1));
+
+        headcode::logger::Event event2{level, "foo.bar"};
+        event2 << "The quick brown \nfox jumps over \nthe lazy dog.";
+        log = headcode::logger::ColorDarkBackgroundFormatter{}.Format(event2);
+        EXPECT_EQ(strip_colors(log), headcode::logger::StandardFormatter{}.Format(event2));
+    }
+}
+
+
+TEST(ColorDarkBackgroundFormatter, prefixes) {
+
+    auto logger = headcode::logger::Logger::GetLogger("foo");
+    auto const & prefixes = logger->GetColorPrefixes();
+    for (auto const & prefix : prefixes) {
+        EXPECT_NE(prefix.find("{foo}"), std::string::npos);
+    }
+    EXPECT_NE(prefixes[2].find("(critical)"), std::string::npos);
+    EXPECT_NE(prefixes[5].find("(debug   )"), std::string::npos);
+
+    auto root_prefixes = headcode::logger::Logger::GetLogger()->GetColorPrefixes();
+    EXPECT_EQ(root_prefixes[3].find('{'), std::string::npos);
+}
+
+
+TEST(Formatter, render_once) {
+
+    headcode::logger::Event event{0};
+    event << "The quick brown fox jumps over the lazy dog.";
+
+    headcode::logger::StandardFormatter standard_a;
+    headcode::logger::StandardFormatter standard_b;
+    headcode::logger::SimpleFormatter simple;
+
+    // same kind of formatters share the very same text of the event
+    auto const & log_a = standard_a.Format(event);
+    auto const & log_b = standard_b.Format(event);
+    EXPECT_EQ(&log_a, &log_b);
+    EXPECT_NE(&log_a, &simple.Format(event));
+    EXPECT_STREQ(simple.Format(event).c_str(), "The quick brown fox jumps over the lazy dog.");
+
+    // changing the message renders anew
+    event << " Again.";
+    EXPECT_STREQ(simple.Format(event).c_str(), "The quick brown fox jumps over the lazy dog. Again.");
+    EXPECT_NE(&log_a, &standard_a.Format(event));
+}
+
+
+TEST(Formatter, render_once_sinks) {
+
+    auto sink_a = headcode::logger::SinkFactory::Create("null:");
+    auto sink_b = headcode::logger::SinkFactory::Create("null:");
+    ASSERT_NE(sink_a, sink_b);
+
+    headcode::logger::Event event{0};
+    event << "The quick brown fox jumps over the lazy dog.";
+    EXPECT_EQ(&sink_a->Format(event), &sink_b->Format(event));
+
+    sink_b->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    EXPECT_NE(&sink_a->Format(event), &sink_b->Format(event));
+}
+
+
+/**
+ * @brief   A formatter rendering events with a prefix of its own (and no render key).
+ */
+class PrefixFormatter : public headcode::logger::Formatter {
+
+    std::string prefix_;        //!< @brief The prefix of each message.
+
+public:
+    /**
+     * @brief   Constructor.
+     * @param   prefix      the prefix of each message.
+     */
+    explicit PrefixFormatter(std::string prefix) : prefix_{std::move(prefix)} {
+    }
+
+private:
+    std::string Format_(headcode::logger::Event const & event) override {
+        return prefix_ + event.GetMessage();
+    }
+};
+
+
+TEST(Formatter, render_generation) {
+
+    headcode::logger::Event event{0};
+    event << "message";
+
+    // a formatter created at the address of a former one does not see its renderings
+    std::optional<PrefixFormatter> formatter;
+    formatter.emplace("a: ");
+    auto generation = formatter->GetGeneration();
+    EXPECT_EQ(formatter->Format(event), "a: message");
+    formatter.reset();
+    formatter.emplace("b: ");
+    EXPECT_NE(formatter->GetGeneration(), generation);
+    EXPECT_EQ(formatter->Format(event), "b: message");
+
+    // more renderings than kept within the event
+    std::vector<std::unique_ptr<PrefixFormatter>> formatters;
+    for (int i = 0; i < 6; ++i) {
+        formatters.push_back(std::make_unique<PrefixFormatter>(std::to_string(i) + ": "));
+    }
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < 6; ++i) {
+            EXPECT_EQ(formatters[i]->Format(event), std::to_string(i) + ": message");
+        }
+    }
+    EXPECT_EQ(&formatters[5]->Format(event), &formatters[5]->Format(event));
+}
+
+TEST(GELFFormatter, regular) {
+
+    headcode::logger::Event event{headcode::logger::Level::kWarning, "gelf"};
+    event << "Disk \"/\" almost full";
+
+    auto log = headcode::logger::GELFFormatter{}.Format(event);
+    EXPECT_EQ(log.find(R"({"version":"1.1","host":")"), 0u);
+    EXPECT_NE(log.find(R"("short_message":"Disk \"/\" almost full")"), std::string::npos);
+    EXPECT_EQ(log.find("full_message"), std::string::npos);
+    EXPECT_NE(log.find(R"("level":4,"_logger":"gelf","_thread_id":)"), std::string::npos);
+    EXPECT_TRUE(std::regex_search(log, std::regex{R"("timestamp":[0-9]+\.[0-9]{6},)"}));
+    EXPECT_EQ(log.back(), '}');
+
+    headcode::logger::Event multi_line{headcode::logger::Level::kCritical};
+    multi_line << "first\nsecond";
+    log = headcode::logger::GELFFormatter{}.Format(multi_line);
+    EXPECT_NE(log.find(R"("short_message":"first","full_message":"first\nsecond")"), std::string::npos);
+    EXPECT_NE(log.find(R"("level":2,)"), std::string::npos);
+}
+
+
+TEST(OTLPFormatter, regular) {
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo, "otlp"};
+    event << "The \"quick\" brown fox";
+
+    auto log = headcode::logger::OTLPFormatter{}.Format(event);
+    EXPECT_TRUE(std::regex_search(log, std::regex{R"(^\{"timeUnixNano":"[0-9]+","severityNumber":9,)"}));
+    EXPECT_NE(log.find(R"("severityText":"info","body":{"stringValue":"The \"quick\" brown fox"})"),
+              std::string::npos);
+    EXPECT_NE(log.find(R"({"key":"logger","value":{"stringValue":"otlp"}})"), std::string::npos);
+    EXPECT_NE(log.find(R"({"key":"thread.id","value":{"intValue":")"), std::string::npos);
+    EXPECT_EQ(log.back(), '}');
+
+    for (auto [level, severity] : std::vector<std::pair<int, int>>{{1, 21}, {2, 13}, {3, 9}, {4, 5}, {10000, 1}}) {
+        headcode::logger::Event leveled{level};
+        log = headcode::logger::OTLPFormatter{}.Format(leveled);
+        EXPECT_NE(log.find(R"("severityNumber":)" + std::to_string(severity) + ","), std::string::npos);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+
+/**
+ * @brief   A local socket standing in for journald.
+ */
+class JournalListener {
+
+    std::string path_;          //!< @brief Path of the socket.
+    int socket_{-1};            //!< @brief The bound socket.
+
+public:
+    /**
+     * @brief   Binds a datagram socket.
+     * @param   name        base name of the socket.
+     */
+    explicit JournalListener(std::string const & name)
+            : path_{"/tmp/hcs-logger-test-" + name + "-" + std::to_string(getpid()) + ".sock"} {
+        unlink(path_.c_str());
+        socket_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+        bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        timeval timeout{5, 0};
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    /**
+     * @brief   Destructor.
+     */
+    ~JournalListener() {
+        close(socket_);
+        unlink(path_.c_str());
+    }
+
+    /**
+     * @brief   Gets the URL of a sink sending to this socket.
+     * @return  The URL.
+     */
+    [[nodiscard]] std::string GetURL() const {
+        return "journal:" + path_;
+    }
+
+    /**
+     * @brief   Receives a datagram; if it passes a file descriptor, its content is returned.
+     * @return  The fields received.
+     */
+    std::string Receive() {
+
+        std::string data(65536, '\0');
+        iovec piece{data.data(), data.size()};
+        union {
+            cmsghdr header_;
+            char buffer_[CMSG_SPACE(sizeof(int))];
+        } control{};
+        msghdr message{};
+        message.msg_iov = &piece;
+        message.msg_iovlen = 1;
+        message.msg_control = control.buffer_;
+        message.msg_controllen = sizeof(control.buffer_);
+
+        auto size = recvmsg(socket_, &message, 0);
+        if (size < 0) {
+            return {};
+        }
+        data.resize(static_cast<std::size_t>(size));
+
+        auto header = CMSG_FIRSTHDR(&message);
+        if ((header != nullptr) && (header->cmsg_type == SCM_RIGHTS)) {
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+            data.clear();
+            char buffer[4096];
+            ssize_t read_size;
+            while ((read_size = pread(fd, buffer, sizeof(buffer), static_cast<off_t>(data.size()))) > 0) {
+                data.append(buffer, static_cast<std::size_t>(read_size));
+            }
+            close(fd);
+        }
+
+        return data;
+    }
+};
+
+
+TEST(JournalSink, regular) {
+
+    JournalListener listener{"journal"};
+    auto sink = headcode::logger::SinkFactory::Create(listener.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kWarning, "journal.test"};
+    event << "Hello journal";
+    sink->Log(event);
+
+    auto fields = listener.Receive();
+    EXPECT_NE(fields.find("PRIORITY=4\n"), std::string::npos);
+    EXPECT_NE(fields.find("MESSAGE=Hello journal\n"), std::string::npos);
+    EXPECT_NE(fields.find("HCS_LOGGER=journal.test\n"), std::string::npos);
+    EXPECT_NE(fields.find("TID=" + std::to_string(event.GetThreadId()) + "\n"), std::string::npos);
+
+    // a multi line message is sent with its size
+    headcode::logger::Event lines{headcode::logger::Level::kInfo, "journal.test"};
+    lines << "one\ntwo";
+    sink->Log(lines);
+
+    fields = listener.Receive();
+    EXPECT_NE(fields.find("PRIORITY=6\n"), std::string::npos);
+    EXPECT_NE(fields.find(std::string{"MESSAGE\n\x07\0\0\0\0\0\0\0one\ntwo\n", 20}), std::string::npos);
+}
+
+
+TEST(JournalSink, memfd) {
+
+    JournalListener listener{"journal-memfd"};
+    auto sink = headcode::logger::SinkFactory::Create(listener.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+
+    // too large for a single datagram
+    headcode::logger::Event event{headcode::logger::Level::kInfo, "journal.test"};
+    event << std::string(1024 * 1024, 'x');
+    sink->Log(event);
+
+    auto fields = listener.Receive();
+    EXPECT_NE(fields.find("MESSAGE=" + std::string(1024 * 1024, 'x') + "\n"), std::string::npos);
+    EXPECT_NE(fields.find("HCS_LOGGER=journal.test\n"), std::string::npos);
+}
@@ -12,6 +12,9 @@
 
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
 
 
 TEST(Logger, empty) {
@@ -95,6 +98,31 @@ TEST(Logger, sinks) {
 }
 
 
+TEST(Logger, remove_sink) {
+
+    LoggerRegistryPurge();
+
+    auto logger = headcode::logger::Logger::GetLogger({});
+    ASSERT_TRUE(logger != nullptr);
+
+    // the logger owns its sinks: dropping our references keeps the sink until it is removed
+    auto sink = headcode::logger::SinkFactory::Create("null:");
+    std::weak_ptr<headcode::logger::Sink> weak_sink = sink;
+    logger->AddSink(sink);
+    sink.reset();
+    EXPECT_EQ(logger->GetSinks().size(), 2u);
+    EXPECT_FALSE(weak_sink.expired());
+
+    logger->RemoveSink(weak_sink.lock());
+    EXPECT_EQ(logger->GetSinks().size(), 1u);
+    EXPECT_TRUE(weak_sink.expired());
+
+    logger->RemoveSink(logger->GetSinks().front());
+    EXPECT_TRUE(logger->GetSinks().empty());
+    logger->RemoveSink(nullptr);
+    EXPECT_TRUE(logger->GetSinks().empty());
+}
+
 TEST(Logger, parenting) {
 
     LoggerRegistryPurge();
@@ -365,4 +393,83 @@ TEST(Logger, parent_sink) {
     EXPECT_GT(logger_foo->GetEventsLogged(), 0ul);
 }
 
+
+/**
+ * @brief   Reads all lines of a file.
+ * @param   path        the file to read.
+ * @return  The lines of the file.
+ */
+static std::vector<std::string> ReadLines(std::string const & path) {
+    std::vector<std::string> lines;
+    std::ifstream file{path, std::ios::in};
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+
+TEST(Logger, barrier_stops_events) {
+
+    LoggerRegistryPurge();
+
+    if (std::filesystem::exists("barrier.log")) {
+        std::filesystem::remove("barrier.log");
+    }
+
+    auto logger = headcode::logger::Logger::GetLogger({});
+    auto sink = headcode::logger::SinkFactory::Create("file:barrier.log");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    logger->SetSink(sink);
+
+    headcode::logger::Debug{} << "stopped\n";
+    headcode::logger::Info{} << "stopped\n";
+    headcode::logger::Warning{} << "passed\n";
+    logger->SetBarrier(headcode::logger::Level::kSilent);
+    headcode::logger::Critical{} << "stopped\n";
+    sink.reset();
+
+    auto lines = ReadLines("barrier.log");
+    ASSERT_EQ(lines.size(), 1ul);
+    EXPECT_EQ(lines[0], "passed");
+}
+
+
+TEST(Logger, backtrace) {
+
+    LoggerRegistryPurge();
+    headcode::logger::Logger::SetBacktraceDepth(3);
+    EXPECT_EQ(headcode::logger::Logger::GetBacktraceDepth(), 3ul);
+
+    if (std::filesystem::exists("backtrace.log")) {
+        std::filesystem::remove("backtrace.log");
+    }
+
+    auto logger = headcode::logger::Logger::GetLogger({});
+    auto sink = headcode::logger::SinkFactory::Create("file:backtrace.log");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    logger->SetSink(sink);
+
+    for (int i = 0; i < 5; ++i) {
+        headcode::logger::Debug{"foo"} << "step " << i << "\n";
+    }
+
+    // events of other threads are not part of our backtrace
+    std::thread{[]() { headcode::logger::Info{"foo"} << "other thread\n"; }}.join();
+
+    headcode::logger::Warning{"foo"} << "failed\n";
+    headcode::logger::Warning{"foo"} << "failed again\n";
+    headcode::logger::Logger::SetBacktraceDepth(0);
+    sink.reset();
+
+    auto lines = ReadLines("backtrace.log");
+    ASSERT_EQ(lines.size(), 5ul);
+    EXPECT_EQ(lines[0], "[backtrace] step 2");
+    EXPECT_EQ(lines[1], "[backtrace] step 3");
+    EXPECT_EQ(lines[2], "[backtrace] step 4");
+    EXPECT_EQ(lines[3], "failed");
+    EXPECT_EQ(lines[4], "failed again");
+}
+
 #endif
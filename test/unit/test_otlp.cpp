@@ -0,0 +1,368 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   A local HTTP server collecting POST requests, one connection at a time.
+ */
+class HTTPStub {
+
+    int socket_{-1};                        //!< @brief The listening socket.
+    unsigned short port_{0};                //!< @brief The port bound to.
+    bool stop_{false};                      //!< @brief Server shall stop.
+    std::deque<int> statuses_;              //!< @brief Statuses of the next responses (200 if empty).
+    std::vector<std::string> heads_;        //!< @brief Heads of the requests received.
+    std::vector<std::string> bodies_;       //!< @brief Bodies of the requests received.
+    std::mutex mutex_;                      //!< @brief Guards all of the above.
+    std::condition_variable received_;      //!< @brief Signals a request received.
+    std::thread thread_;                    //!< @brief The serving thread.
+
+public:
+    /**
+     * @brief   Listens on a free port on 127.0.0.1.
+     * @param   statuses    statuses of the first responses.
+     */
+    explicit HTTPStub(std::deque<int> statuses = {}) : statuses_{std::move(statuses)} {
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        socklen_t size = sizeof(address);
+        getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &size);
+        port_ = ntohs(address.sin_port);
+        listen(socket_, 4);
+        thread_ = std::thread{&HTTPStub::Serve, this};
+    }
+
+    /**
+     * @brief   Destructor.
+     */
+    ~HTTPStub() {
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex_};
+            stop_ = true;
+        }
+        thread_.join();
+        close(socket_);
+    }
+
+    /**
+     * @brief   Gets the URL of a sink exporting to this server.
+     * @param   query       the query part of the URL.
+     * @return  The URL.
+     */
+    [[nodiscard]] std::string GetURL(std::string const & query = {}) const {
+        return "otlp+http://127.0.0.1:" + std::to_string(port_) + "/v1/logs" + (query.empty() ? "" : "?" + query);
+    }
+
+    /**
+     * @brief   Waits for requests.
+     * @param   count       the number of requests to wait for.
+     * @return  The bodies of the requests received so far.
+     */
+    std::vector<std::string> Wait(std::size_t count) {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        received_.wait_for(lock, std::chrono::seconds{5}, [&]() { return bodies_.size() >= count; });
+        return bodies_;
+    }
+
+    /**
+     * @brief   Gets the heads of the requests received.
+     * @return  The heads of the requests received so far.
+     */
+    std::vector<std::string> GetHeads() {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        return heads_;
+    }
+
+private:
+    /**
+     * @brief   Checks if the server shall stop.
+     * @return  true, if the server shall stop.
+     */
+    bool IsStopped() {
+        auto lock = std::unique_lock<std::mutex>{mutex_};
+        return stop_;
+    }
+
+    /**
+     * @brief   Accepts connections and answers requests until stopped.
+     */
+    void Serve() {
+
+        while (!IsStopped()) {
+
+            pollfd pending{socket_, POLLIN, 0};
+            if (poll(&pending, 1, 50) != 1) {
+                continue;
+            }
+            auto connection = accept(socket_, nullptr, nullptr);
+            std::string data;
+            char buffer[4096];
+
+            while (!IsStopped()) {
+
+                auto head_end = data.find("\r\n\r\n");
+                if (head_end != std::string::npos) {
+                    auto head = data.substr(0, head_end + 4);
+                    auto length = head.find("Content-Length: ");
+                    auto size = (length == std::string::npos) ? 0
+                                                              : std::strtoul(head.c_str() + length + 16, nullptr, 10);
+                    if (data.size() >= head.size() + size) {
+                        int status = 200;
+                        {
+                            auto lock = std::unique_lock<std::mutex>{mutex_};
+                            heads_.push_back(head);
+                            bodies_.push_back(data.substr(head.size(), size));
+                            if (!statuses_.empty()) {
+                                status = statuses_.front();
+                                statuses_.pop_front();
+                            }
+                        }
+                        received_.notify_all();
+                        data.erase(0, head.size() + size);
+                        auto response = "HTTP/1.1 " + std::to_string(status) + " Stub\r\nContent-Length: 2\r\n\r\n{}";
+                        send(connection, response.data(), response.size(), MSG_NOSIGNAL);
+                        continue;
+                    }
+                }
+
+                pollfd readable{connection, POLLIN, 0};
+                if (poll(&readable, 1, 50) != 1) {
+                    continue;
+                }
+                auto received = recv(connection, buffer, sizeof(buffer), 0);
+                if (received <= 0) {
+                    break;
+                }
+                data.append(buffer, static_cast<std::size_t>(received));
+            }
+            close(connection);
+        }
+    }
+};
+
+
+/**
+ * @brief   Counts the occurrences of a text.
+ * @param   text        the text to search in.
+ * @param   what        the text to search for.
+ * @return  The number of occurrences.
+ */
+static std::size_t Count(std::string const & text, std::string const & what) {
+    std::size_t count = 0;
+    for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + what.size())) {
+        ++count;
+    }
+    return count;
+}
+
+
+TEST(OTLPSink, batch_size) {
+
+    HTTPStub server;
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("batch=3&interval=60000&service=test"));
+    ASSERT_NE(sink.get(), nullptr);
+    EXPECT_EQ(sink->GetDescription(), "OTLPSink to " + server.GetURL().substr(5));
+
+    for (auto level : {headcode::logger::Level::kCritical, headcode::logger::Level::kWarning,
+                       headcode::logger::Level::kDebug}) {
+        headcode::logger::Event event{level};
+        event << "Event " << static_cast<int>(level);
+        sink->Log(event);
+    }
+
+    // a full batch goes out at once
+    auto bodies = server.Wait(1);
+    ASSERT_EQ(bodies.size(), 1u);
+    auto const & body = bodies.front();
+    EXPECT_EQ(body.find(R"({"resourceLogs":[{"resource":{"attributes":[{"key":"service.name",)"
+                        R"("value":{"stringValue":"test"}})"),
+              0u);
+    EXPECT_NE(body.find(R"("scope":{"name":"hcs-logger")"), std::string::npos);
+    EXPECT_EQ(Count(body, R"("timeUnixNano":)"), 3u);
+    EXPECT_NE(body.find(R"("severityNumber":21,"severityText":"critical","body":{"stringValue":"Event 1"})"),
+              std::string::npos);
+    EXPECT_NE(body.find(R"("severityNumber":13,)"), std::string::npos);
+    EXPECT_NE(body.find(R"("severityNumber":5,)"), std::string::npos);
+    EXPECT_EQ(body.substr(body.size() - 6), "]}]}]}");
+
+    auto head = server.GetHeads().front();
+    EXPECT_EQ(head.find("POST /v1/logs HTTP/1.1\r\n"), 0u);
+    EXPECT_NE(head.find("Content-Type: application/json\r\n"), std::string::npos);
+}
+
+
+TEST(OTLPSink, batch_interval) {
+
+    HTTPStub server;
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("batch=100&interval=50"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "Alone";
+    sink->Log(event);
+
+    auto bodies = server.Wait(1);
+    ASSERT_EQ(bodies.size(), 1u);
+    EXPECT_EQ(Count(bodies.front(), R"("timeUnixNano":)"), 1u);
+    EXPECT_NE(bodies.front().find(R"("severityNumber":9,"severityText":"info","body":{"stringValue":"Alone"})"),
+              std::string::npos);
+}
+
+
+TEST(OTLPSink, priority) {
+
+    // the critical event does not wait for a full batch and goes ahead of the others
+    HTTPStub server;
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("batch=100&interval=60000&priority=critical"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    for (int i = 0; i < 3; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+    headcode::logger::Event critical{headcode::logger::Level::kCritical};
+    critical << "Urgent";
+    auto sequence = critical.GetSequence();
+    sink->Log(critical);
+
+    auto bodies = server.Wait(1);
+    ASSERT_EQ(bodies.size(), 1u);
+    auto const & body = bodies.front();
+    EXPECT_EQ(Count(body, R"("timeUnixNano":)"), 4u);
+    EXPECT_LT(body.find(R"("stringValue":"Urgent")"), body.find(R"("stringValue":"Event 0")"));
+    EXPECT_NE(body.find(R"({"key":"sequence","value":{"intValue":")" + std::to_string(sequence) + R"("}})"),
+              std::string::npos);
+}
+
+
+TEST(OTLPSink, flush) {
+
+    // a flush does not wait for a full batch
+    HTTPStub server;
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("batch=100&interval=60000"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "Flushed";
+    sink->Log(event);
+
+    EXPECT_TRUE(sink->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{5}));
+    EXPECT_EQ(server.Wait(0).size(), 1u);
+}
+
+
+TEST(OTLPSink, flush_while_logging) {
+
+    std::string filename = "test_otlp_flush_" + std::to_string(getpid()) + ".jsonl";
+    unlink(filename.c_str());
+
+    // a flush waits for the records logged before, not for the queue to run empty
+    auto sink = headcode::logger::SinkFactory::Create("otlp+file:" + filename + "?batch=16&interval=10");
+    ASSERT_NE(sink.get(), nullptr);
+
+    std::atomic<bool> stop{false};
+    std::thread thread{[&]() {
+        for (int i = 0; !stop.load(); ++i) {
+            headcode::logger::Event event{headcode::logger::Level::kInfo};
+            event << "Background " << i;
+            sink->Log(event);
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+        }
+    }};
+
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Flushed " << i;
+        sink->Log(event);
+        EXPECT_TRUE(sink->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{5}));
+
+        std::ifstream file{filename};
+        std::string content{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        EXPECT_NE(content.find(R"("stringValue":"Flushed )" + std::to_string(i) + R"(")"), std::string::npos);
+    }
+
+    stop = true;
+    thread.join();
+    sink.reset();
+    unlink(filename.c_str());
+}
+
+TEST(OTLPSink, retry) {
+
+    // the collector is busy for the first request, the batch is sent again
+    HTTPStub server{{503}};
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("batch=1"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "Again";
+    sink->Log(event);
+
+    auto bodies = server.Wait(2);
+    ASSERT_EQ(bodies.size(), 2u);
+    EXPECT_EQ(bodies[0], bodies[1]);
+}
+
+
+TEST(OTLPSink, file) {
+
+    std::string filename = "test_otlp_" + std::to_string(getpid()) + ".jsonl";
+    unlink(filename.c_str());
+
+    auto sink = headcode::logger::SinkFactory::Create("otlp+file:" + filename + "?batch=2&interval=50");
+    ASSERT_NE(sink.get(), nullptr);
+    EXPECT_EQ(sink->GetDescription(), "OTLPSink to file " + filename);
+
+    for (int i = 0; i < 3; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    std::vector<std::string> lines;
+    for (int i = 0; (i < 100) && (lines.size() < 2); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        lines.clear();
+        std::ifstream file{filename};
+        for (std::string line; std::getline(file, line);) {
+            lines.push_back(line);
+        }
+    }
+
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(Count(lines[0], R"("timeUnixNano":)"), 2u);
+    EXPECT_EQ(Count(lines[1], R"("timeUnixNano":)"), 1u);
+    EXPECT_NE(lines[1].find(R"("body":{"stringValue":"Event 2"})"), std::string::npos);
+    unlink(filename.c_str());
+}
@@ -0,0 +1,233 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   Reads all lines of a file.
+ * @param   path        the file.
+ * @return  The lines of the file.
+ */
+static std::vector<std::string> ReadLines(std::filesystem::path const & path) {
+    std::vector<std::string> res;
+    std::ifstream in{path};
+    std::string line;
+    while (std::getline(in, line)) {
+        res.push_back(line);
+    }
+    return res;
+}
+
+
+/**
+ * @brief   Removes a file if it exists.
+ * @param   path        the file.
+ */
+static void RemoveFile(std::filesystem::path const & path) {
+    if (std::filesystem::exists(path)) {
+        std::filesystem::remove(path);
+    }
+}
+
+
+TEST(RingSink, critical) {
+
+    auto log_file = std::filesystem::path{"test_ring_critical.log"};
+    RemoveFile(log_file);
+
+    auto sink = headcode::logger::SinkFactory::Create("ring:?events=5&target=file:test_ring_critical.log");
+    ASSERT_NE(sink.get(), nullptr);
+
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kDebug, "ring"};
+        event << "Debug " << i;
+        sink->Log(event);
+    }
+    EXPECT_FALSE(std::filesystem::exists(log_file));
+
+    headcode::logger::Event critical{headcode::logger::Level::kCritical, "ring"};
+    critical << "Boom.";
+    sink->Log(critical);
+
+    // the last 5 events: 4 debug ones and the critical one
+    auto lines = ReadLines(log_file);
+    ASSERT_EQ(lines.size(), 5u);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_NE(lines[i].find("(debug   ) {ring}: Debug " + std::to_string(i + 6)), std::string::npos);
+    }
+    EXPECT_NE(lines[4].find("(critical) {ring}: Boom."), std::string::npos);
+
+    // dumped events are gone
+    sink->Dump();
+    EXPECT_EQ(ReadLines(log_file).size(), 5u);
+}
+
+
+TEST(RingSink, bytes) {
+
+    auto log_file = std::filesystem::path{"test_ring_bytes.log"};
+    RemoveFile(log_file);
+
+    auto sink = headcode::logger::SinkFactory::Create("ring:?bytes=100&dump=none&target=file:test_ring_bytes.log");
+    ASSERT_NE(sink.get(), nullptr);
+
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kCritical};
+        event << std::string(30, static_cast<char>('a' + i));
+        sink->Log(event);
+    }
+    EXPECT_FALSE(std::filesystem::exists(log_file));
+
+    // 3 messages of 30 bytes fit
+    sink->Dump();
+    auto lines = ReadLines(log_file);
+    ASSERT_EQ(lines.size(), 3u);
+    EXPECT_NE(lines[0].find(std::string(30, 'h')), std::string::npos);
+    EXPECT_NE(lines[1].find(std::string(30, 'i')), std::string::npos);
+    EXPECT_NE(lines[2].find(std::string(30, 'j')), std::string::npos);
+}
+
+
+TEST(RingSink, invalid_parameters) {
+
+    auto log_file = std::filesystem::path{"test_ring_invalid.log"};
+    RemoveFile(log_file);
+
+    // invalid numbers and levels fall back to the defaults: 1000 events, dump on critical ones
+    auto sink = headcode::logger::SinkFactory::Create(
+            "ring:?events=-1&bytes=-1&dump=2x&target=file:test_ring_invalid.log");
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event warning{headcode::logger::Level::kWarning, "ring"};
+    warning << "Warning.";
+    sink->Log(warning);
+    EXPECT_FALSE(std::filesystem::exists(log_file));
+
+    headcode::logger::Event critical{headcode::logger::Level::kCritical, "ring"};
+    critical << "Boom.";
+    sink->Log(critical);
+    EXPECT_EQ(ReadLines(log_file).size(), 2u);
+}
+
+
+/**
+ * @brief   Logs some events into a ring sink and crashes.
+ */
+static void CrashWithRing() {
+    headcode::logger::InstallCrashHandler();
+    auto sink = headcode::logger::SinkFactory::Create("ring:?target=file:test_ring_crash.log");
+    for (int i = 0; i < 3; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kDebug, "crash"};
+        event << "Line " << i << "\nsecond line";
+        sink->Log(event);
+    }
+    std::raise(SIGSEGV);
+}
+
+
+TEST(RingSink, crash) {
+
+    auto log_file = std::filesystem::path{"test_ring_crash.log"};
+    RemoveFile(log_file);
+
+    EXPECT_EXIT(CrashWithRing(), testing::KilledBySignal(SIGSEGV), "");
+
+    auto lines = ReadLines(log_file);
+    ASSERT_EQ(lines.size(), 6u);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NE(lines[i * 2].find("(debug   ) {crash}: Line " + std::to_string(i)), std::string::npos);
+        EXPECT_NE(lines[i * 2 + 1].find("(debug   ) {crash}: second line"), std::string::npos);
+    }
+
+    // same layout as the StandardFormatter
+    EXPECT_EQ(lines[0].size(), std::string{"[2021-04-08T10:15:02,123+00:00] (debug   ) {crash}: Line 0"}.size());
+}
+
+
+/**
+ * @brief   Logs some events into a ring sink dumping to a binary log and crashes.
+ */
+static void CrashWithBinaryRing() {
+    headcode::logger::InstallCrashHandler();
+    auto sink = headcode::logger::SinkFactory::Create("ring:?target=file:test_ring_crash.hlog?format=binary");
+    headcode::logger::Event event{headcode::logger::Level::kDebug, "crash"};
+    event << "Binary line";
+    sink->Log(event);
+    std::raise(SIGSEGV);
+}
+
+
+TEST(RingSink, crash_binary) {
+
+    auto log_file = std::filesystem::path{"test_ring_crash.hlog"};
+    RemoveFile(log_file);
+
+    // no text lines in a binary log: the events go to stderr
+    EXPECT_EXIT(CrashWithBinaryRing(), testing::KilledBySignal(SIGSEGV), "\\(debug   \\) \\{crash\\}: Binary line");
+    EXPECT_TRUE(!std::filesystem::exists(log_file) || (std::filesystem::file_size(log_file) == 0));
+}
+
+
+/**
+ * @brief   Depth never reached by Overflow().
+ */
+static int volatile overflow_limit = 1 << 30;
+
+
+/**
+ * @brief   Recurses until the stack overflows.
+ * @param   depth       the current depth.
+ * @return  Nothing useful.
+ */
+static int Overflow(int depth) {
+    char volatile frame[1024];
+    frame[0] = static_cast<char>(depth);
+    if (depth == overflow_limit) {
+        return frame[0];
+    }
+    return Overflow(depth + 1) + frame[0];
+}
+
+
+/**
+ * @brief   Logs an event into a ring sink on another thread, which then overflows its stack.
+ */
+static void CrashWithOverflow() {
+    headcode::logger::InstallCrashHandler();
+    auto logger = headcode::logger::Logger::GetLogger("overflow");
+    logger->SetSink(headcode::logger::SinkFactory::Create("ring:?target=file:test_ring_overflow.log"));
+    logger->SetBarrier(headcode::logger::Level::kDebug);
+    std::thread{[]() {
+        headcode::logger::Debug{"overflow"} << "Before the overflow";
+        Overflow(0);
+    }}.join();
+}
+
+
+TEST(RingSink, crash_overflow_thread) {
+
+    auto log_file = std::filesystem::path{"test_ring_overflow.log"};
+    RemoveFile(log_file);
+
+    // a logging thread got its own alternate signal stack
+    EXPECT_EXIT(CrashWithOverflow(), testing::KilledBySignal(SIGSEGV), "");
+
+    auto lines = ReadLines(log_file);
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find("(debug   ) {overflow}: Before the overflow"), std::string::npos);
+}
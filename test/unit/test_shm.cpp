@@ -0,0 +1,177 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   Creates a ring name unique to this test process.
+ * @param   name        the base name.
+ * @return  A ring name.
+ */
+static std::string GetRingName(std::string const & name) {
+    return "hcs-logger-test-" + name + "-" + std::to_string(getpid());
+}
+
+
+TEST(ShmSink, regular) {
+
+    auto name = GetRingName("regular");
+    headcode::logger::ShmRingReader::Unlink(name);
+
+    auto sink = headcode::logger::SinkFactory::Create("shm:" + name);
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    headcode::logger::ShmRingReader reader{name};
+    ASSERT_TRUE(reader.IsOpen());
+    std::string record;
+    EXPECT_FALSE(reader.Next(record));
+
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    // a record spanning many slots
+    headcode::logger::Event large{headcode::logger::Level::kInfo};
+    large << std::string(2000, 'x');
+    sink->Log(large);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(reader.Next(record));
+        EXPECT_EQ(record, "Event " + std::to_string(i));
+    }
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(record, std::string(2000, 'x'));
+    EXPECT_FALSE(reader.Next(record));
+    EXPECT_EQ(reader.GetLost(), 0u);
+
+    headcode::logger::ShmRingReader::Unlink(name);
+}
+
+
+TEST(ShmSink, overrun) {
+
+    auto name = GetRingName("overrun");
+    headcode::logger::ShmRingReader::Unlink(name);
+
+    // 32 slots only
+    auto sink = headcode::logger::SinkFactory::Create("shm:" + name + "?size=4096&slot=128");
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    for (int i = 0; i < 100; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    // only the most recent ones survived
+    headcode::logger::ShmRingReader reader{name};
+    ASSERT_TRUE(reader.IsOpen());
+    std::vector<std::string> records;
+    std::string record;
+    while (reader.Next(record)) {
+        records.push_back(record);
+    }
+    ASSERT_FALSE(records.empty());
+    EXPECT_LE(records.size(), 32u);
+    EXPECT_EQ(records.back(), "Event 99");
+    EXPECT_EQ(reader.GetLost() + records.size(), 100u);
+
+    headcode::logger::ShmRingReader::Unlink(name);
+}
+
+
+TEST(ShmSink, resume) {
+
+    auto name = GetRingName("resume");
+    headcode::logger::ShmRingReader::Unlink(name);
+
+    auto sink = headcode::logger::SinkFactory::Create("shm:" + name);
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    std::string record;
+    for (int i = 0; i < 4; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    {
+        headcode::logger::ShmRingReader reader{name};
+        ASSERT_TRUE(reader.Next(record));
+        EXPECT_EQ(record, "Event 0");
+        ASSERT_TRUE(reader.Next(record));
+        EXPECT_EQ(record, "Event 1");
+    }
+
+    // a new reader continues where the previous one stopped
+    headcode::logger::ShmRingReader reader{name};
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(record, "Event 2");
+    ASSERT_TRUE(reader.Next(record));
+    EXPECT_EQ(record, "Event 3");
+    EXPECT_FALSE(reader.Next(record));
+
+    headcode::logger::ShmRingReader::Unlink(name);
+}
+
+
+TEST(ShmSink, concurrent) {
+
+    auto name = GetRingName("concurrent");
+    headcode::logger::ShmRingReader::Unlink(name);
+
+    auto sink = headcode::logger::SinkFactory::Create("shm:" + name + "?size=1048576");
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 250; ++i) {
+                headcode::logger::Event event{headcode::logger::Level::kInfo};
+                event << "Thread " << t << ", event " << i;
+                sink->Log(event);
+            }
+        });
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    headcode::logger::ShmRingReader reader{name};
+    std::vector<int> next(4, 0);
+    std::string record;
+    int count = 0;
+    while (reader.Next(record)) {
+        int t = 0;
+        int i = 0;
+        ASSERT_EQ(std::sscanf(record.c_str(), "Thread %d, event %d", &t, &i), 2);
+        ASSERT_LT(t, 4);
+        EXPECT_EQ(i, next[t]++);
+        ++count;
+    }
+    EXPECT_EQ(count, 1000);
+    EXPECT_EQ(reader.GetLost(), 0u);
+
+    headcode::logger::ShmRingReader::Unlink(name);
+}
@@ -10,16 +10,19 @@
 
 #include <gtest/gtest.h>
 
+#include <csignal>
 #include <fstream>
 #include <filesystem>
+#include <memory>
 #include <regex>
+#include <thread>
 
 
 TEST(Sink, default_producers) {
     // Enforces registration of all default sink producers.
     headcode::logger::Logger::GetLogger({});
     auto producers = headcode::logger::SinkFactory::GetProducerList();
-    EXPECT_EQ(producers.size(), 4u);
+    EXPECT_EQ(producers.size(), 11u);
 }
 
 
@@ -82,6 +85,28 @@ TEST(Sink, barrier) {
 }
 
 
+TEST(Sink, formatter) {
+
+    auto sink = headcode::logger::SinkFactory::Create("null:");
+    auto formatter = sink->GetFormatter();
+    ASSERT_NE(formatter.get(), nullptr);
+    EXPECT_EQ(formatter->GetRenderKey(), "standard");
+
+    // the formatter handed out outlives its replacement
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    EXPECT_EQ(formatter->GetRenderKey(), "standard");
+    EXPECT_EQ(sink->GetFormatter()->GetRenderKey(), "simple");
+
+    // ... but the sink lets go of it right away
+    std::weak_ptr<headcode::logger::Formatter const> weak_formatter = sink->GetFormatter();
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    EXPECT_TRUE(weak_formatter.expired());
+
+    sink->SetFormatter(nullptr);
+    EXPECT_EQ(sink->GetFormatter()->GetRenderKey(), "simple");
+}
+
 TEST(Sink, file) {
 
     auto log_file = std::filesystem::path{"test.log"};
@@ -127,6 +152,150 @@ TEST(Sink, file) {
 }
 
 
+TEST(Sink, file_buffered) {
+
+    auto log_file = std::filesystem::path{"test_buffered.log"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    auto sink = headcode::logger::SinkFactory::Create("file:test_buffered.log?buffer=4096");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    auto event_info = headcode::logger::Info();
+    event_info << "This is a info message." << std::endl;
+    sink->Log(event_info);
+    EXPECT_EQ(std::filesystem::file_size(log_file), 0u);
+
+    // critical events go out at once, with all events before
+    auto event_critical = headcode::logger::Critical();
+    event_critical << "This is a critical message." << std::endl;
+    sink->Log(event_critical);
+    EXPECT_EQ(std::filesystem::file_size(log_file), 52u);
+
+    auto event_debug = headcode::logger::Debug();
+    event_debug << "This is a debug message." << std::endl;
+    sink->Log(event_debug);
+    EXPECT_EQ(std::filesystem::file_size(log_file), 52u);
+    sink->Dump();
+    EXPECT_EQ(std::filesystem::file_size(log_file), 77u);
+}
+
+
+TEST(Sink, file_sync) {
+
+    for (auto name : {"test_sync_level.log", "test_sync_periodic.log"}) {
+        if (std::filesystem::exists(name)) {
+            std::filesystem::remove(name);
+        }
+    }
+
+    // syncing after Warning and Critical events, unbuffered: all events written at once
+    auto level_sink = headcode::logger::SinkFactory::Create("file:test_sync_level.log?sync=warning");
+    level_sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    auto event_info = headcode::logger::Info();
+    event_info << "This is a info message." << std::endl;
+    level_sink->Log(event_info);
+    EXPECT_EQ(std::filesystem::file_size("test_sync_level.log"), 24u);
+    auto event_warning = headcode::logger::Warning();
+    event_warning << "This is a warning message." << std::endl;
+    level_sink->Log(event_warning);
+    EXPECT_EQ(std::filesystem::file_size("test_sync_level.log"), 51u);
+
+    // the sync thread writes out the buffer as well
+    auto periodic_sink = headcode::logger::SinkFactory::Create(
+            "file:test_sync_periodic.log?buffer=4096&sync=periodic&sync_interval=20");
+    periodic_sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    periodic_sink->Log(event_info);
+    for (int i = 0; (i < 100) && (std::filesystem::file_size("test_sync_periodic.log") == 0); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    }
+    EXPECT_EQ(std::filesystem::file_size("test_sync_periodic.log"), 24u);
+}
+
+
+TEST(Sink, shutdown) {
+
+    auto log_file = std::filesystem::path{"test_shutdown.log"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    auto sink = headcode::logger::SinkFactory::Create("file:test_shutdown.log?buffer=4096&sync=flush");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    auto logger = headcode::logger::Logger::GetLogger("shutdown");
+    logger->SetSink(sink);
+    logger->SetBarrier(headcode::logger::Level::kInfo);
+
+    headcode::logger::Info("shutdown") << "This is a info message." << std::endl;
+    EXPECT_EQ(std::filesystem::file_size(log_file), 0u);
+
+    EXPECT_TRUE(logger->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{1}));
+    EXPECT_EQ(std::filesystem::file_size(log_file), 24u);
+
+    headcode::logger::Info("shutdown") << "This is another info message." << std::endl;
+    EXPECT_TRUE(headcode::logger::Shutdown(std::chrono::steady_clock::now() + std::chrono::seconds{1}));
+    EXPECT_EQ(std::filesystem::file_size(log_file), 54u);
+
+    logger->SetSink(nullptr);
+}
+
+
+TEST(Sink, flush_deadline) {
+
+    auto log_file = std::filesystem::path{"test_flush_deadline.log"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    // past the deadline the buffer is still written, yet no sync is started
+    auto sink = headcode::logger::SinkFactory::Create("file:test_flush_deadline.log?buffer=4096&sync=flush");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "This is a info message." << std::endl;
+    sink->Log(event);
+    EXPECT_EQ(std::filesystem::file_size(log_file), 0u);
+
+    EXPECT_FALSE(sink->Flush(std::chrono::steady_clock::now() - std::chrono::seconds{1}));
+    EXPECT_EQ(std::filesystem::file_size(log_file), 24u);
+    EXPECT_TRUE(sink->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{1}));
+}
+
+
+/**
+ * @brief   Logs some events into a buffered file sink and crashes.
+ */
+static void CrashWithBufferedFile() {
+    headcode::logger::InstallCrashHandler();
+    auto sink = headcode::logger::SinkFactory::Create("file:test_buffered_crash.log?buffer=65536");
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    for (int i = 0; i < 3; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Line " << i << std::endl;
+        sink->Log(event);
+    }
+    std::raise(SIGSEGV);
+}
+
+
+TEST(Sink, file_buffered_crash) {
+
+    auto log_file = std::filesystem::path{"test_buffered_crash.log"};
+    if (std::filesystem::exists(log_file)) {
+        std::filesystem::remove(log_file);
+    }
+
+    EXPECT_EXIT(CrashWithBufferedFile(), testing::KilledBySignal(SIGSEGV), "");
+
+    std::ifstream log_in{log_file};
+    std::string line;
+    for (int i = 0; i < 3; ++i) {
+        std::getline(log_in, line);
+        EXPECT_EQ(line, "Line " + std::to_string(i));
+    }
+}
+
+
 TEST(Sink, description) {
 
     headcode::logger::Event event{1};
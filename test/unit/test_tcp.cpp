@@ -0,0 +1,194 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+
+/**
+ * @brief   A local TCP server accepting a single connection at a time.
+ */
+class TCPServer {
+
+    int socket_{-1};                    //!< @brief The bound socket.
+    int connection_{-1};                //!< @brief The accepted connection.
+    unsigned short port_{0};            //!< @brief The port bound to.
+
+public:
+    /**
+     * @brief   Binds to a free port on 127.0.0.1 (but does not listen yet).
+     */
+    TCPServer() {
+        socket_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        socklen_t size = sizeof(address);
+        getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &size);
+        port_ = ntohs(address.sin_port);
+    }
+
+    /**
+     * @brief   Destructor.
+     */
+    ~TCPServer() {
+        if (connection_ >= 0) {
+            close(connection_);
+        }
+        close(socket_);
+    }
+
+    /**
+     * @brief   Waits for a connection.
+     * @return  true, if a client connected.
+     */
+    bool Accept() {
+        pollfd pending{socket_, POLLIN, 0};
+        if (poll(&pending, 1, 5000) != 1) {
+            return false;
+        }
+        connection_ = accept(socket_, nullptr, nullptr);
+        timeval timeout{5, 0};
+        setsockopt(connection_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return connection_ >= 0;
+    }
+
+    /**
+     * @brief   Gets the URL of a sink connecting to this server.
+     * @param   query       the query part of the URL.
+     * @return  The URL.
+     */
+    [[nodiscard]] std::string GetURL(std::string const & query = {}) const {
+        return "tcp://127.0.0.1:" + std::to_string(port_) + (query.empty() ? "" : "?" + query);
+    }
+
+    /**
+     * @brief   Starts accepting connections.
+     */
+    void Listen() {
+        listen(socket_, 1);
+    }
+
+    /**
+     * @brief   Reads bytes from the connection.
+     * @param   size        the number of bytes to read.
+     * @return  The bytes read; less on timeout.
+     */
+    std::string Read(std::size_t size) {
+        std::string data;
+        char buffer[4096];
+        while (data.size() < size) {
+            auto received = recv(connection_, buffer, std::min(sizeof(buffer), size - data.size()), 0);
+            if (received <= 0) {
+                break;
+            }
+            data.append(buffer, static_cast<std::size_t>(received));
+        }
+        return data;
+    }
+};
+
+
+TEST(TCPSink, regular) {
+
+    TCPServer server;
+    server.Listen();
+
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+        expected += "Event " + std::to_string(i) + "\n";
+    }
+
+    ASSERT_TRUE(server.Accept());
+    EXPECT_EQ(server.Read(expected.size()), expected);
+}
+
+
+TEST(TCPSink, buffer_until_connected) {
+
+    // the server does not accept connections yet: the sink has to hold the events back
+    TCPServer server;
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i << "\n";
+        sink->Log(event);
+        expected += "Event " + std::to_string(i) + "\n";
+    }
+
+    usleep(300000);
+    server.Listen();
+
+    ASSERT_TRUE(server.Accept());
+    EXPECT_EQ(server.Read(expected.size()), expected);
+}
+
+
+TEST(TCPSink, length_framing) {
+
+    TCPServer server;
+    server.Listen();
+
+    auto sink = headcode::logger::SinkFactory::Create(server.GetURL("framing=length"));
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << std::string(300, 'x');
+    sink->Log(event);
+
+    ASSERT_TRUE(server.Accept());
+    auto prefix = server.Read(4);
+    ASSERT_EQ(prefix.size(), 4ul);
+    EXPECT_EQ(prefix, std::string("\0\0\x01\x2c", 4));
+    EXPECT_EQ(server.Read(300), std::string(300, 'x'));
+}
+
+
+TEST(TCPSink, gelf) {
+
+    TCPServer server;
+    server.Listen();
+
+    auto sink = headcode::logger::SinkFactory::Create("gelf+" + server.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "Hello GELF";
+    sink->Log(event);
+
+    ASSERT_TRUE(server.Accept());
+    std::string message;
+    for (auto c = server.Read(1); (c.size() == 1) && (c[0] != '\0'); c = server.Read(1)) {
+        message += c;
+    }
+    EXPECT_EQ(message.find(R"({"version":"1.1",)"), 0u);
+    EXPECT_NE(message.find(R"("short_message":"Hello GELF")"), std::string::npos);
+    EXPECT_EQ(message.back(), '}');
+}
@@ -10,10 +10,13 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <fstream>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <thread>
+#include <vector>
 
 
 TEST(Threading, concurrent) {
@@ -63,4 +66,146 @@ TEST(Threading, concurrent) {
     }
     log_file.close();
     EXPECT_EQ(line_count, thread_count * loop_count);
-}
\ No newline at end of file
+}
+
+TEST(Threading, combining) {
+
+    if (std::filesystem::exists("thread_combining.log")) {
+        std::filesystem::remove("thread_combining.log");
+    }
+
+    auto logger = headcode::logger::Logger::GetLogger("combining");
+    auto sink = headcode::logger::SinkFactory::Create("file:thread_combining.log?combine=true");
+    logger->SetSink(sink);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+    logger->SetBarrier(headcode::logger::Level::kDebug);
+
+    std::uint64_t thread_count = 100;
+    std::uint64_t loop_count = 1000;
+    std::function<void(std::uint64_t)> thread_function = [&](std::uint64_t id) {
+        for (std::uint64_t i = 0; i < loop_count; ++i) {
+            headcode::logger::Debug{"combining"} << id << " " << i << "\n";
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::uint64_t id = 0; id < thread_count; ++id) {
+        threads.emplace_back(thread_function, id);
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    // every record is complete and each thread's records are in order
+    std::vector<std::uint64_t> next(thread_count, 0);
+    std::ifstream log_file{"thread_combining.log"};
+    std::uint64_t id = 0;
+    std::uint64_t i = 0;
+    std::uint64_t line_count = 0;
+    while (log_file >> id >> i) {
+        ASSERT_LT(id, thread_count);
+        EXPECT_EQ(i, next[id]++);
+        ++line_count;
+    }
+    EXPECT_EQ(line_count, thread_count * loop_count);
+
+    logger->SetSink(nullptr);
+}
+
+TEST(Threading, reconfigure) {
+
+    for (auto const & name : {"thread_reconfigure_a.log", "thread_reconfigure_b.log"}) {
+        if (std::filesystem::exists(name)) {
+            std::filesystem::remove(name);
+        }
+    }
+
+    auto logger = headcode::logger::Logger::GetLogger("reconfigure");
+    auto sink_a = headcode::logger::SinkFactory::Create("file:thread_reconfigure_a.log");
+    auto sink_b = headcode::logger::SinkFactory::Create("file:thread_reconfigure_b.log");
+    logger->SetSink(sink_a);
+    logger->SetBarrier(headcode::logger::Level::kDebug);
+
+    std::string log_message{"Log message of a thread."};
+    std::uint64_t thread_count = 8;
+    std::uint64_t loop_count = 10000;
+    std::atomic<std::uint64_t> running{thread_count};
+    std::function<void()> thread_function = [&]() {
+        for (std::uint64_t i = 0; i < loop_count; ++i) {
+            headcode::logger::Info{"reconfigure"} << log_message;
+        }
+        --running;
+    };
+
+    std::vector<std::thread> threads{thread_count};
+    for (auto & thread : threads) {
+        thread = std::thread{thread_function};
+    }
+
+    // turn barriers, sinks and formatters while the threads log
+    for (std::uint64_t round = 0; running > 0; ++round) {
+        logger->SetBarrier((round % 3 == 0) ? headcode::logger::Level::kSilent : headcode::logger::Level::kDebug);
+        sink_a->SetBarrier((round % 5 == 0) ? headcode::logger::Level::kWarning : headcode::logger::Level::kDebug);
+        sink_a->SetFormatter(std::make_unique<headcode::logger::StandardFormatter>());
+        if (round % 2 == 0) {
+            logger->SetSink(sink_a);
+        } else {
+            logger->AddSink(sink_b);
+        }
+        std::this_thread::yield();
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(logger->GetEventsLogged(), thread_count * loop_count);
+
+    for (auto const & [name, sink] : {std::make_pair("thread_reconfigure_a.log", sink_a),
+                                      std::make_pair("thread_reconfigure_b.log", sink_b)}) {
+        std::ifstream log_file{name};
+        std::uint64_t line_count = 0;
+        std::string line;
+        while (std::getline(log_file, line)) {
+            ++line_count;
+            ASSERT_GE(line.size(), log_message.size());
+            EXPECT_EQ(line.substr(line.size() - log_message.size()), log_message);
+        }
+        EXPECT_EQ(line_count, sink->GetEventsLogged());
+    }
+
+    logger->SetSink(nullptr);
+}
+
+
+TEST(Threading, remove_while_logging) {
+
+    auto logger = headcode::logger::Logger::GetLogger("remove");
+    logger->SetSink(headcode::logger::SinkFactory::Create("null:"));
+    logger->SetBarrier(headcode::logger::Level::kDebug);
+
+    std::atomic<bool> stop{false};
+    std::function<void()> thread_function = [&]() {
+        while (!stop) {
+            headcode::logger::Info{"remove"} << "Log message of a thread.";
+        }
+    };
+
+    std::vector<std::thread> threads{4};
+    for (auto & thread : threads) {
+        thread = std::thread{thread_function};
+    }
+
+    // a sink removed is gone as soon as RemoveSink() returns, no matter how busy the logger is
+    for (int round = 0; round < 1000; ++round) {
+        auto sink = headcode::logger::SinkFactory::Create("null:");
+        std::weak_ptr<headcode::logger::Sink> weak_sink = sink;
+        logger->AddSink(std::move(sink));
+        logger->RemoveSink(weak_sink.lock());
+        ASSERT_TRUE(weak_sink.expired());
+    }
+
+    stop = true;
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    logger->SetSink(nullptr);
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   Reads all lines of a file.
+ * @param   path        the file to read.
+ * @return  The lines of the file.
+ */
+static std::vector<std::string> ReadLines(std::string const & path) {
+    std::vector<std::string> lines;
+    std::ifstream file{path, std::ios::in};
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+
+TEST(TraceEvent, regular) {
+
+    auto start = std::chrono::system_clock::now() - std::chrono::milliseconds{5};
+    headcode::logger::TraceEvent event{"trace",
+                                       "query",
+                                       headcode::logger::TracePhase::kComplete,
+                                       start,
+                                       std::chrono::microseconds{1200},
+                                       headcode::logger::Level::kSilent};
+    EXPECT_EQ(event.GetMessage(), "query");
+    EXPECT_EQ(event.GetTracePhase(), headcode::logger::TracePhase::kComplete);
+    EXPECT_EQ(event.GetTraceDuration().count(), 1200);
+    EXPECT_EQ(event.GetTimePoint(), start);
+
+    headcode::logger::Event regular{headcode::logger::Level::kSilent};
+    EXPECT_EQ(regular.GetTracePhase(), headcode::logger::TracePhase::kNone);
+    EXPECT_EQ(regular.GetTraceDuration().count(), 0);
+}
+
+
+TEST(ScopedTimer, chrome_trace) {
+
+    if (std::filesystem::exists("trace.json")) {
+        std::filesystem::remove("trace.json");
+    }
+
+    auto logger = headcode::logger::Logger::GetLogger("trace.timer");
+    logger->SetBarrier(headcode::logger::Level::kDebug);
+    logger->SetSink(headcode::logger::SinkFactory::Create("file:trace.json?format=chrome"));
+
+    {
+        headcode::logger::ScopedTimer outer{"trace.timer", "outer", headcode::logger::Level::kDebug,
+                                            headcode::logger::ScopedTimer::Mode::kBeginEnd};
+        {
+            headcode::logger::ScopedTimer inner{"trace.timer", "inner"};
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            EXPECT_GE(inner.GetElapsed().count(), 2000);
+        }
+        headcode::logger::Info{"trace.timer"} << "between";
+    }
+
+    auto lines = ReadLines("trace.json");
+    ASSERT_EQ(lines.size(), 5ul);
+    EXPECT_EQ(lines[0], "[");
+
+    auto pid = std::to_string(getpid());
+    EXPECT_TRUE(std::regex_match(
+            lines[1], std::regex{R"(\{"name":"outer","cat":"trace.timer","ph":"B","ts":[0-9]+,"pid":)" + pid +
+                                 R"(,"tid":[0-9]+\},)"}));
+    EXPECT_TRUE(std::regex_match(lines[2],
+                                 std::regex{R"(\{"name":"inner","cat":"trace.timer","ph":"X","ts":[0-9]+,"dur":[0-9]+,)"
+                                            R"("pid":[0-9]+,"tid":[0-9]+\},)"}));
+    EXPECT_TRUE(std::regex_match(lines[3],
+                                 std::regex{R"(\{"name":"between","cat":"trace.timer","ph":"i","s":"t","ts":[0-9]+,)"
+                                            R"("pid":[0-9]+,"tid":[0-9]+,"args":\{"level":"info"\}\},)"}));
+    EXPECT_TRUE(std::regex_match(lines[4], std::regex{R"(\{"name":"outer","cat":"trace.timer","ph":"E",.*)"}));
+
+    // the complete event holds the time spent in its scope
+    std::smatch match;
+    ASSERT_TRUE(std::regex_search(lines[2], match, std::regex{R"("dur":([0-9]+))"}));
+    EXPECT_GE(std::stol(match[1]), 2000);
+
+    logger->SetBarrier(headcode::logger::Level::kUndefined);
+    logger->SetSink({});
+}
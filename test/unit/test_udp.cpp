@@ -0,0 +1,229 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+
+
+/**
+ * @brief   A local UDP listener.
+ */
+class UDPListener {
+
+    int socket_{-1};                //!< @brief The bound socket.
+    unsigned short port_{0};        //!< @brief The port bound to.
+
+public:
+    /**
+     * @brief   Binds to a free port on 127.0.0.1.
+     */
+    UDPListener() {
+        socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        socklen_t size = sizeof(address);
+        getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &size);
+        port_ = ntohs(address.sin_port);
+        timeval timeout{5, 0};
+        setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    /**
+     * @brief   Destructor.
+     */
+    ~UDPListener() {
+        close(socket_);
+    }
+
+    /**
+     * @brief   Gets the URL of a sink sending to this listener.
+     * @param   query       the query part of the URL.
+     * @return  The URL.
+     */
+    [[nodiscard]] std::string GetURL(std::string const & query = {}) const {
+        return "udp://127.0.0.1:" + std::to_string(port_) + (query.empty() ? "" : "?" + query);
+    }
+
+    /**
+     * @brief   Receives a datagram.
+     * @return  The datagram received; empty on timeout.
+     */
+    std::string Receive() {
+        char buffer[65536];
+        auto size = recv(socket_, buffer, sizeof(buffer), 0);
+        return size > 0 ? std::string(buffer, static_cast<std::size_t>(size)) : std::string{};
+    }
+};
+
+
+TEST(UDPSink, regular) {
+
+    UDPListener listener;
+    auto sink = headcode::logger::SinkFactory::Create(listener.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+    EXPECT_EQ(sink->GetDescription(), "UDPSink to 127.0.0.1:" + listener.GetURL().substr(16));
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    for (int i = 0; i < 100; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(listener.Receive(), "Event " + std::to_string(i));
+    }
+}
+
+
+TEST(UDPSink, split) {
+
+    UDPListener listener;
+    auto sink = headcode::logger::SinkFactory::Create(listener.GetURL("datagram=16"));
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    headcode::logger::Event large{headcode::logger::Level::kInfo};
+    large << std::string(16, 'a') << std::string(16, 'b') << "c";
+    sink->Log(large);
+
+    headcode::logger::Event small{headcode::logger::Level::kInfo};
+    small << "small";
+    sink->Log(small);
+
+    EXPECT_EQ(listener.Receive(), std::string(16, 'a'));
+    EXPECT_EQ(listener.Receive(), std::string(16, 'b'));
+    EXPECT_EQ(listener.Receive(), "c");
+    EXPECT_EQ(listener.Receive(), "small");
+}
+
+
+TEST(UDPSink, gelf) {
+
+    UDPListener listener;
+    auto sink = headcode::logger::SinkFactory::Create("gelf+" + listener.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << "Hello GELF";
+    sink->Log(event);
+
+    auto message = listener.Receive();
+    EXPECT_EQ(message.find(R"({"version":"1.1",)"), 0u);
+    EXPECT_NE(message.find(R"("short_message":"Hello GELF")"), std::string::npos);
+}
+
+
+TEST(UDPSink, gelf_chunked) {
+
+    UDPListener listener;
+    auto sink = headcode::logger::SinkFactory::Create("gelf+" + listener.GetURL("chunk=512"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event event{headcode::logger::Level::kInfo};
+    event << std::string(2000, 'x');
+    sink->Log(event);
+
+    // chunks: 0x1e 0x0f, 8 bytes message id, sequence number, sequence count, data
+    std::map<int, std::string> chunks;
+    std::string id;
+    for (int i = 0; i < 5; ++i) {
+        auto chunk = listener.Receive();
+        ASSERT_GT(chunk.size(), 12u);
+        EXPECT_LE(chunk.size(), 512u);
+        EXPECT_EQ(chunk.substr(0, 2), "\x1e\x0f");
+        if (id.empty()) {
+            id = chunk.substr(2, 8);
+        }
+        EXPECT_EQ(chunk.substr(2, 8), id);
+        EXPECT_EQ(chunk[11], 5);
+        chunks[chunk[10]] = chunk.substr(12);
+    }
+
+    ASSERT_EQ(chunks.size(), 5u);
+    std::string message;
+    for (auto const & [sequence, data] : chunks) {
+        message += data;
+    }
+    EXPECT_EQ(message.back(), '}');
+    EXPECT_NE(message.find(std::string(2000, 'x')), std::string::npos);
+}
+
+
+TEST(UDPSink, gelf_too_many_chunks) {
+
+    UDPListener listener;
+    auto sink = headcode::logger::SinkFactory::Create("gelf+" + listener.GetURL("chunk=100"));
+    ASSERT_NE(sink.get(), nullptr);
+
+    headcode::logger::Event large{headcode::logger::Level::kInfo};
+    large << std::string(200 * 100, 'x');
+    sink->Log(large);
+
+    headcode::logger::Event small{headcode::logger::Level::kInfo};
+    small << "small";
+    sink->Log(small);
+
+    // the message too large for 128 chunks is dropped
+    EXPECT_NE(listener.Receive().find(R"("short_message":"small")"), std::string::npos);
+}
+
+
+#ifdef HAVE_ZLIB
+TEST(UDPSink, gelf_compressed) {
+
+    for (std::string compress : {"zlib", "gzip"}) {
+
+        UDPListener listener;
+        auto sink = headcode::logger::SinkFactory::Create("gelf+" + listener.GetURL("compress=" + compress));
+        ASSERT_NE(sink.get(), nullptr);
+
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Hello " << compress << " " << std::string(1000, 'x');
+        sink->Log(event);
+
+        auto datagram = listener.Receive();
+        ASSERT_FALSE(datagram.empty());
+        EXPECT_LT(datagram.size(), 1000u);
+        if (compress == "zlib") {
+            EXPECT_EQ(datagram[0], '\x78');
+        } else {
+            EXPECT_EQ(datagram.substr(0, 2), "\x1f\x8b");
+        }
+
+        // windowBits 47: detect zlib or gzip header
+        z_stream stream{};
+        ASSERT_EQ(inflateInit2(&stream, 47), Z_OK);
+        std::string message(4096, '\0');
+        stream.next_in = reinterpret_cast<Bytef *>(datagram.data());
+        stream.avail_in = static_cast<uInt>(datagram.size());
+        stream.next_out = reinterpret_cast<Bytef *>(message.data());
+        stream.avail_out = static_cast<uInt>(message.size());
+        EXPECT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+        message.resize(stream.total_out);
+        inflateEnd(&stream);
+
+        EXPECT_NE(message.find("\"short_message\":\"Hello " + compress + " xxx"), std::string::npos);
+    }
+}
+#endif
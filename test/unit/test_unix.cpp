@@ -0,0 +1,175 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+
+/**
+ * @brief   A local agent listening on a unix domain socket.
+ */
+class UnixAgent {
+
+    std::string path_;              //!< @brief Path of the socket.
+    int socket_{-1};                //!< @brief The listening socket.
+    int connection_{-1};            //!< @brief The accepted connection.
+
+public:
+    /**
+     * @brief   Listens on a unix domain socket.
+     * @param   name        base name of the socket.
+     * @param   type        SOCK_STREAM or SOCK_SEQPACKET.
+     */
+    UnixAgent(std::string const & name, int type) {
+        // sinks live on in the factory: each agent gets a path of its own
+        static int count = 0;
+        path_ = "/tmp/hcs-logger-test-" + name + "-" + std::to_string(getpid()) + "-" + std::to_string(count++) +
+                ".sock";
+        unlink(path_.c_str());
+        socket_ = socket(AF_UNIX, type, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+        bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        listen(socket_, 1);
+    }
+
+    /**
+     * @brief   Destructor.
+     */
+    ~UnixAgent() {
+        if (connection_ >= 0) {
+            close(connection_);
+        }
+        close(socket_);
+        unlink(path_.c_str());
+    }
+
+    /**
+     * @brief   Accepts the connection of the sink.
+     * @return  true, if a sink connected.
+     */
+    bool Accept() {
+        pollfd pending{socket_, POLLIN, 0};
+        if (poll(&pending, 1, 5000) != 1) {
+            return false;
+        }
+        connection_ = accept(socket_, nullptr, nullptr);
+        timeval timeout{5, 0};
+        setsockopt(connection_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return connection_ >= 0;
+    }
+
+    /**
+     * @brief   Gets the URL of a sink writing to this agent.
+     * @param   query       the query part of the URL.
+     * @return  The URL.
+     */
+    [[nodiscard]] std::string GetURL(std::string const & query = {}) const {
+        return "unix:" + path_ + (query.empty() ? "" : "?" + query);
+    }
+
+    /**
+     * @brief   Reads from the connection.
+     * @param   size        the number of bytes to read (stream) or the maximum size of a message (seqpacket).
+     * @param   message     stop after a single message.
+     * @return  The bytes read.
+     */
+    std::string Read(std::size_t size, bool message = false) {
+        std::string data;
+        std::string buffer(65536, '\0');
+        while (data.size() < size) {
+            auto received = recv(connection_, buffer.data(), std::min(buffer.size(), size - data.size()), 0);
+            if (received <= 0) {
+                break;
+            }
+            data.append(buffer.data(), static_cast<std::size_t>(received));
+            if (message) {
+                break;
+            }
+        }
+        return data;
+    }
+};
+
+
+TEST(UnixSink, stream) {
+
+    UnixAgent agent{"unix-stream", SOCK_STREAM};
+    auto sink = headcode::logger::SinkFactory::Create(agent.GetURL());
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+        expected += "Event " + std::to_string(i) + "\n";
+    }
+
+    ASSERT_TRUE(agent.Accept());
+    EXPECT_EQ(agent.Read(expected.size()), expected);
+}
+
+
+TEST(UnixSink, seqpacket) {
+
+    UnixAgent agent{"unix-seqpacket", SOCK_SEQPACKET};
+    auto sink = headcode::logger::SinkFactory::Create(agent.GetURL("type=seqpacket"));
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    for (int i = 0; i < 10; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << "Event " << i;
+        sink->Log(event);
+    }
+
+    ASSERT_TRUE(agent.Accept());
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(agent.Read(1024, true), "Event " + std::to_string(i));
+    }
+}
+
+
+TEST(UnixSink, overflow) {
+
+    UnixAgent agent{"unix-overflow", SOCK_STREAM};
+    auto sink = headcode::logger::SinkFactory::Create(agent.GetURL("mode=nonblocking"));
+    ASSERT_NE(sink.get(), nullptr);
+    sink->SetFormatter(std::make_unique<headcode::logger::SimpleFormatter>());
+
+    // far more than the socket buffer holds: the agent does not read yet
+    std::string expected;
+    for (int i = 0; i < 2000; ++i) {
+        headcode::logger::Event event{headcode::logger::Level::kInfo};
+        event << i << ":" << std::string(1000, 'x');
+        sink->Log(event);
+        expected += std::to_string(i) + ":" + std::string(1000, 'x') + "\n";
+    }
+
+    ASSERT_TRUE(agent.Accept());
+    std::string received;
+    std::thread reader{[&]() { received = agent.Read(expected.size()); }};
+    sink->Dump();
+    reader.join();
+
+    EXPECT_EQ(received.size(), expected.size());
+    EXPECT_TRUE(received == expected);
+}
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @brief   Finds the threads of this process by name.
+ * @param   name        the thread name.
+ * @return  The kernel thread ids of the threads with that name.
+ */
+static std::vector<pid_t> FindThreads(std::string const & name) {
+    std::vector<pid_t> threads;
+    for (auto const & task : std::filesystem::directory_iterator{"/proc/self/task"}) {
+        std::string comm;
+        std::ifstream{task.path() / "comm"} >> comm;
+        if (comm == name) {
+            threads.push_back(std::stoi(task.path().filename().string()));
+        }
+    }
+    return threads;
+}
+
+
+TEST(Worker, settings) {
+
+    auto sink = headcode::logger::SinkFactory::Create("file:worker.log?sync=periodic");
+    EXPECT_GE(headcode::logger::GetWorkerCount(), 1ul);
+    auto threads = FindThreads("hcs-sync");
+    ASSERT_FALSE(threads.empty());
+
+    headcode::logger::WorkerSettings settings;
+    settings.cpus = {0};
+    settings.name_prefix = "test-";
+    settings.nice = 5;
+    EXPECT_TRUE(headcode::logger::SetWorkerSettings(settings));
+    EXPECT_EQ(headcode::logger::GetWorkerSettings().name_prefix, "test-");
+    EXPECT_EQ(headcode::logger::GetWorkerSettings().nice, 5);
+
+    EXPECT_TRUE(FindThreads("hcs-sync").empty());
+    threads = FindThreads("test-sync");
+    ASSERT_FALSE(threads.empty());
+    for (auto tid : threads) {
+        cpu_set_t cpus;
+        ASSERT_EQ(sched_getaffinity(tid, sizeof(cpus), &cpus), 0);
+        EXPECT_EQ(CPU_COUNT(&cpus), 1);
+        EXPECT_TRUE(CPU_ISSET(0, &cpus));
+        EXPECT_EQ(getpriority(PRIO_PROCESS, static_cast<id_t>(tid)), 5);
+    }
+
+    // workers started later run with the settings too
+    auto other = headcode::logger::SinkFactory::Create("file:worker_other.log?sync=periodic");
+    EXPECT_EQ(FindThreads("test-sync").size(), threads.size() + 1);
+
+    // lowering the nice value again needs privileges: the result does not matter here
+    headcode::logger::SetWorkerSettings(headcode::logger::WorkerSettings{});
+    EXPECT_EQ(FindThreads("test-sync").size(), 0ul);
+}
+
+
+TEST(Worker, wakeup) {
+
+    // spinning, yielding and sleeping consumers all get every record
+    for (auto busy_wait : {0, 200, 5000}) {
+
+        headcode::logger::WorkerSettings settings;
+        settings.spin = std::chrono::microseconds{busy_wait};
+        settings.yield = std::chrono::microseconds{busy_wait};
+        headcode::logger::SetWorkerSettings(settings);
+        EXPECT_EQ(headcode::logger::GetWorkerSettings().spin.count(), busy_wait);
+
+        std::string filename = "worker_wakeup_" + std::to_string(busy_wait) + ".jsonl";
+        if (std::filesystem::exists(filename)) {
+            std::filesystem::remove(filename);
+        }
+        auto sink = headcode::logger::SinkFactory::Create("otlp+file:" + filename + "?batch=1");
+        ASSERT_NE(sink.get(), nullptr);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 250; ++i) {
+                    headcode::logger::Event event{headcode::logger::Level::kInfo};
+                    event << "Record " << i;
+                    sink->Log(event);
+                    if (i % 50 == 0) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+                    }
+                }
+            });
+        }
+        for (auto & thread : threads) {
+            thread.join();
+        }
+        EXPECT_TRUE(sink->Flush(std::chrono::steady_clock::now() + std::chrono::seconds{5}));
+
+        std::ifstream file{filename};
+        std::string line;
+        std::size_t lines = 0;
+        while (std::getline(file, line)) {
+            ++lines;
+        }
+        EXPECT_EQ(lines, 1000u);
+    }
+
+    headcode::logger::SetWorkerSettings(headcode::logger::WorkerSettings{});
+}
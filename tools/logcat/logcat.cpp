@@ -0,0 +1,381 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   Prints the usage of this tool.
+ */
+static void ShowUsage() {
+    std::cout << "Usage: hcs-logcat [OPTION]... [FILE]...\n"
+                 "Decodes binary logs (as written by the BinaryFormatter) to text.\n"
+                 "\n"
+                 "With no FILE, or when FILE is -, read standard input.\n"
+                 "\n"
+                 "  -f, --from=TIME      show only events at or after TIME\n"
+                 "  -t, --to=TIME        show only events at or before TIME\n"
+                 "  -l, --logger=NAME    show only events of logger NAME and its children\n"
+                 "  -L, --level=LEVEL    show only events up to LEVEL (name or number)\n"
+                 "  -h, --help           show this help and exit\n"
+                 "  -v, --version        show version and exit\n"
+                 "\n"
+                 "TIME is given in UTC as YYYY-MM-DDThh:mm[:ss] or as hh:mm[:ss] on the day of the\n"
+                 "first event of a file. With filters, seekable files are searched via their index\n"
+                 "and only blocks which may hold matching events are decoded.\n";
+}
+
+
+/**
+ * @brief   The filters given on the command line.
+ */
+struct Query {
+    std::optional<std::string> from_;        //!< @brief Show events at or after this time.
+    std::optional<std::string> to_;          //!< @brief Show events at or before this time.
+    std::optional<std::string> logger_;      //!< @brief Show events of this logger (and its children).
+    int level_{0};                           //!< @brief Show events up to this level (0 for all).
+
+    /**
+     * @brief   Checks if any filter is set.
+     * @return  true, if a filter is set.
+     */
+    [[nodiscard]] bool IsFiltering() const {
+        return from_.has_value() || to_.has_value() || logger_.has_value() || (level_ > 0);
+    }
+};
+
+
+/**
+ * @brief   The time range of a query resolved for a single file.
+ */
+struct TimeRange {
+    std::chrono::system_clock::time_point from_{std::chrono::system_clock::time_point::min()};
+    std::chrono::system_clock::time_point to_{std::chrono::system_clock::time_point::max()};
+};
+
+
+/**
+ * @brief   Parses a log level given as name or number.
+ * @param   text        the level text.
+ * @param   level       receives the level value.
+ * @return  true, if the level is valid.
+ */
+static bool ParseLevel(std::string const & text, int & level) {
+
+    for (auto l : {Level::kCritical, Level::kWarning, Level::kInfo, Level::kDebug}) {
+        auto name = GetLevelText(l);
+        auto lower = text;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        if (lower == name) {
+            level = static_cast<int>(l);
+            return true;
+        }
+    }
+
+    try {
+        std::size_t pos = 0;
+        level = std::stoi(text, &pos);
+        return (pos == text.size()) && (level > 0);
+    } catch (...) {
+        return false;
+    }
+}
+
+
+/**
+ * @brief   Parses a time given on the command line.
+ * @param   text        the time text: "YYYY-MM-DDThh:mm[:ss]" or "hh:mm[:ss]".
+ * @param   day         the day (any time within it) to use if the text has no date.
+ * @param   upper       the time is an upper bound.
+ * @param   time_point  receives the time.
+ * @return  true, if the time is valid.
+ */
+static bool ParseTime(std::string const & text,
+                      std::chrono::system_clock::time_point day,
+                      bool upper,
+                      std::chrono::system_clock::time_point & time_point) {
+
+    std::tm tm{};
+    int consumed = 0;
+    if (std::sscanf(text.c_str(),
+                    "%4d-%2d-%2dT%2d:%2d%n",
+                    &tm.tm_year,
+                    &tm.tm_mon,
+                    &tm.tm_mday,
+                    &tm.tm_hour,
+                    &tm.tm_min,
+                    &consumed) == 5) {
+        tm.tm_year -= 1900;
+        tm.tm_mon -= 1;
+    } else if (std::sscanf(text.c_str(), "%2d:%2d%n", &tm.tm_hour, &tm.tm_min, &consumed) == 2) {
+        auto t = std::chrono::system_clock::to_time_t(day);
+        std::tm day_tm{};
+        gmtime_r(&t, &day_tm);
+        tm.tm_year = day_tm.tm_year;
+        tm.tm_mon = day_tm.tm_mon;
+        tm.tm_mday = day_tm.tm_mday;
+    } else {
+        return false;
+    }
+
+    auto rest = text.substr(static_cast<std::size_t>(consumed));
+    if (!rest.empty()) {
+        int seconds_consumed = 0;
+        if ((std::sscanf(rest.c_str(), ":%2d%n", &tm.tm_sec, &seconds_consumed) != 1) ||
+            (static_cast<std::size_t>(seconds_consumed) != rest.size())) {
+            return false;
+        }
+    }
+
+    auto t = timegm(&tm);
+    if (t == -1) {
+        return false;
+    }
+    time_point = std::chrono::system_clock::from_time_t(t);
+    if (upper) {
+        // the upper bound includes the whole second or minute given
+        time_point += (rest.empty() ? std::chrono::seconds{60} : std::chrono::seconds{1}) -
+                      std::chrono::system_clock::duration{1};
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief   Resolves the time range of a query for a file.
+ * @param   query       the query.
+ * @param   day         the time of the first event of the file.
+ * @param   range       receives the time range.
+ * @return  true, if the time range is valid.
+ */
+static bool ResolveTimeRange(Query const & query, std::chrono::system_clock::time_point day, TimeRange & range) {
+    if (query.from_.has_value() && !ParseTime(query.from_.value(), day, false, range.from_)) {
+        std::cerr << "hcs-logcat: invalid time: " << query.from_.value() << std::endl;
+        return false;
+    }
+    if (query.to_.has_value() && !ParseTime(query.to_.value(), day, true, range.to_)) {
+        std::cerr << "hcs-logcat: invalid time: " << query.to_.value() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief   Checks if a logger name matches the logger given by the query.
+ * @param   query       the query.
+ * @param   logger      the logger name.
+ * @return  true, if the logger is the one asked for or one of its children.
+ */
+static bool MatchLogger(Query const & query, std::string const & logger) {
+    if (!query.logger_.has_value()) {
+        return true;
+    }
+    auto const & name = query.logger_.value();
+    return (logger == name) || ((logger.size() > name.size()) && (logger.compare(0, name.size(), name) == 0) &&
+                                (logger[name.size()] == '.'));
+}
+
+
+/**
+ * @brief   Checks if an event matches the query.
+ * @param   query       the query.
+ * @param   range       the time range of the query.
+ * @param   record      the event.
+ * @return  true, if the event is to be shown.
+ */
+static bool Match(Query const & query, TimeRange const & range, BinaryRecord const & record) {
+    return (record.time_point >= range.from_) && (record.time_point <= range.to_) &&
+           ((query.level_ == 0) || ((record.level > 0) && (record.level <= query.level_))) &&
+           MatchLogger(query, record.logger);
+}
+
+
+/**
+ * @brief   Checks if an indexed block may hold events matching the query.
+ * @param   query       the query.
+ * @param   range       the time range of the query.
+ * @param   block       the block.
+ * @return  true, if the block needs to be decoded.
+ */
+static bool MayMatch(Query const & query, TimeRange const & range, BinaryBlock const & block) {
+    if (!block.indexed) {
+        return true;
+    }
+    if ((block.last < range.from_) || (block.first > range.to_)) {
+        return false;
+    }
+    if ((query.level_ > 0) && ((block.max_level <= 0) || (block.min_level > query.level_))) {
+        return false;
+    }
+    return std::any_of(block.loggers.begin(), block.loggers.end(), [&](auto const & logger) {
+        return MatchLogger(query, logger);
+    });
+}
+
+
+/**
+ * @brief   Decodes a binary log stream to stdout.
+ * @param   in          the binary log stream.
+ * @param   name        the name of the stream (for error messages).
+ * @param   query       the filters to apply.
+ * @return  true, if the whole stream has been decoded.
+ */
+static bool Decode(std::istream & in, std::string const & name, Query const & query) {
+
+    BinaryReader reader{in};
+    BinaryRecord record;
+    TimeRange range;
+    bool resolved = !query.from_.has_value() && !query.to_.has_value();
+    while (reader.Next(record)) {
+        if (!resolved) {
+            if (!ResolveTimeRange(query, record.time_point, range)) {
+                return false;
+            }
+            resolved = true;
+        }
+        if (Match(query, range, record)) {
+            std::cout << StandardFormatter::Render(record.time_point, record.level, record.logger, record.message);
+        }
+    }
+
+    if (reader.HasError()) {
+        std::cerr << "hcs-logcat: " << name << ": malformed binary log." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief   Decodes only the blocks of a seekable binary log which may match the query.
+ * @param   in          the seekable binary log stream.
+ * @param   name        the name of the stream (for error messages).
+ * @param   query       the filters to apply.
+ * @return  true, if all blocks of interest have been decoded.
+ */
+static bool Search(std::istream & in, std::string const & name, Query const & query) {
+
+    auto blocks = BinaryReader::LoadIndex(in);
+    if (blocks.empty() || !blocks.front().indexed) {
+        // no index at the start of the file: at least a day for the time range is needed
+        return Decode(in, name, query);
+    }
+
+    TimeRange range;
+    if (!ResolveTimeRange(query, blocks.front().first, range)) {
+        return false;
+    }
+
+    BinaryReader reader{in};
+    BinaryRecord record;
+    for (auto const & block : blocks) {
+        if (!MayMatch(query, range, block)) {
+            continue;
+        }
+        reader.Seek(block);
+        while (reader.Next(record)) {
+            if (Match(query, range, record)) {
+                std::cout << StandardFormatter::Render(record.time_point, record.level, record.logger, record.message);
+            }
+        }
+        if (reader.HasError()) {
+            std::cerr << "hcs-logcat: " << name << ": malformed binary log." << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char ** argv) {
+
+    static struct option long_options[] = {{"from", required_argument, nullptr, 'f'},
+                                           {"to", required_argument, nullptr, 't'},
+                                           {"logger", required_argument, nullptr, 'l'},
+                                           {"level", required_argument, nullptr, 'L'},
+                                           {"help", no_argument, nullptr, 'h'},
+                                           {"version", no_argument, nullptr, 'v'},
+                                           {nullptr, 0, nullptr, 0}};
+
+    Query query;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:t:l:L:hv", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':
+                query.from_ = optarg;
+                break;
+
+            case 't':
+                query.to_ = optarg;
+                break;
+
+            case 'l':
+                query.logger_ = optarg;
+                break;
+
+            case 'L':
+                if (!ParseLevel(optarg, query.level_)) {
+                    std::cerr << "hcs-logcat: invalid level: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+
+            case 'h':
+                ShowUsage();
+                return 0;
+
+            case 'v':
+                std::cout << "hcs-logcat " << GetVersionString() << std::endl;
+                return 0;
+
+            default:
+                std::cerr << "Try 'hcs-logcat --help' for more information." << std::endl;
+                return 1;
+        }
+    }
+
+    std::vector<std::string> files{argv + optind, argv + argc};
+    if (files.empty()) {
+        files.emplace_back("-");
+    }
+
+    bool ok = true;
+    for (auto const & file : files) {
+        if (file == "-") {
+            ok = Decode(std::cin, "stdin", query) && ok;
+            continue;
+        }
+        std::ifstream in{file, std::ios::in | std::ios::binary};
+        if (!in.is_open()) {
+            std::cerr << "hcs-logcat: " << file << ": cannot open file." << std::endl;
+            ok = false;
+            continue;
+        }
+        ok = (query.IsFiltering() ? Search(in, file, query) : Decode(in, file, query)) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+ * This file is part of the headcode.space logger.
+ *
+ * The 'LICENSE.txt' file in the project root holds the software license.
+ * Copyright (C) 2021 headcode.space e.U.
+ * Oliver Maurhart <info@headcode.space>, https://www.headcode.space
+ */
+
+#include <headcode/logger/logger.hpp>
+
+#include <getopt.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace headcode::logger;
+
+
+/**
+ * @brief   Set by SIGINT and SIGTERM.
+ */
+static std::atomic<bool> stop{false};
+
+
+/**
+ * @brief   Signal handler: stop collecting.
+ */
+static void OnSignal(int) {
+    stop = true;
+}
+
+
+/**
+ * @brief   Prints the usage of this tool.
+ */
+static void ShowUsage() {
+    std::cout << "Usage: hcs-logcollect [OPTION]... NAME\n"
+                 "Drains the shared memory ring of a \"shm:NAME\" sink to stdout or a file.\n"
+                 "\n"
+                 "Runs until interrupted (SIGINT, SIGTERM), then drains what is left.\n"
+                 "\n"
+                 "  -o, --output=FILE      append to FILE instead of writing to stdout\n"
+                 "  -i, --interval=MS      poll the ring every MS milliseconds (default: 10)\n"
+                 "  -x, --exit             exit as soon as the ring is empty\n"
+                 "  -u, --unlink           remove the shared memory object when done\n"
+                 "  -h, --help             show this help and exit\n"
+                 "  -v, --version          show version and exit\n";
+}
+
+
+/**
+ * @brief   Moves all records currently in the ring to the output.
+ * @param   reader      the ring reader.
+ * @param   out         the output.
+ * @param   lost        the number of lost slots reported so far (updated).
+ * @return  The number of records moved.
+ */
+static std::uint64_t Drain(ShmRingReader & reader, std::ostream & out, std::uint64_t & lost) {
+
+    std::uint64_t count = 0;
+    std::string record;
+    while (reader.Next(record)) {
+        out << record;
+        ++count;
+    }
+    out.flush();
+
+    if (reader.GetLost() != lost) {
+        std::cerr << "hcs-logcollect: lost " << reader.GetLost() - lost << " slot(s)." << std::endl;
+        lost = reader.GetLost();
+    }
+
+    return count;
+}
+
+
+int main(int argc, char ** argv) {
+
+    static struct option long_options[] = {{"output", required_argument, nullptr, 'o'},
+                                           {"interval", required_argument, nullptr, 'i'},
+                                           {"exit", no_argument, nullptr, 'x'},
+                                           {"unlink", no_argument, nullptr, 'u'},
+                                           {"help", no_argument, nullptr, 'h'},
+                                           {"version", no_argument, nullptr, 'v'},
+                                           {nullptr, 0, nullptr, 0}};
+
+    std::string output;
+    auto interval = std::chrono::milliseconds{10};
+    bool exit_when_empty = false;
+    bool unlink = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "o:i:xuhv", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'i':
+                try {
+                    interval = std::chrono::milliseconds{std::stoul(optarg)};
+                } catch (...) {
+                    std::cerr << "hcs-logcollect: invalid interval: " << optarg << std::endl;
+                    return 1;
+                }
+                break;
+
+            case 'x':
+                exit_when_empty = true;
+                break;
+
+            case 'u':
+                unlink = true;
+                break;
+
+            case 'h':
+                ShowUsage();
+                return 0;
+
+            case 'v':
+                std::cout << "hcs-logcollect " << GetVersionString() << std::endl;
+                return 0;
+
+            default:
+                std::cerr << "Try 'hcs-logcollect --help' for more information." << std::endl;
+                return 1;
+        }
+    }
+
+    if (optind + 1 != argc) {
+        std::cerr << "hcs-logcollect: need exactly one ring NAME." << std::endl;
+        std::cerr << "Try 'hcs-logcollect --help' for more information." << std::endl;
+        return 1;
+    }
+    std::string name{argv[optind]};
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output, std::ios::out | std::ios::app | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "hcs-logcollect: " << output << ": cannot open file." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream & out = output.empty() ? std::cout : file;
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    // the application may not have created the ring yet
+    auto reader = std::make_unique<ShmRingReader>(name);
+    while (!reader->IsOpen() && !exit_when_empty && !stop) {
+        std::this_thread::sleep_for(interval);
+        reader = std::make_unique<ShmRingReader>(name);
+    }
+    if (!reader->IsOpen()) {
+        std::cerr << "hcs-logcollect: " << name << ": no such ring." << std::endl;
+        return 1;
+    }
+
+    std::uint64_t lost = 0;
+    while (!stop) {
+        if ((Drain(*reader, out, lost) == 0) && exit_when_empty) {
+            break;
+        }
+        std::this_thread::sleep_for(interval);
+    }
+    Drain(*reader, out, lost);
+
+    if (unlink) {
+        ShmRingReader::Unlink(name);
+    }
+
+    return 0;
+}